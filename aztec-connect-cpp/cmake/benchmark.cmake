@@ -0,0 +1,22 @@
+if(BENCHMARKS)
+    include(FetchContent)
+
+    FetchContent_Declare(
+        benchmark
+        GIT_REPOSITORY https://github.com/google/benchmark.git
+        GIT_TAG v1.7.1
+    )
+
+    FetchContent_GetProperties(benchmark)
+    if(NOT benchmark_POPULATED)
+        FetchContent_Populate(benchmark)
+        set(BENCHMARK_ENABLE_TESTING OFF CACHE BOOL "Benchmark tests off")
+        set(BENCHMARK_ENABLE_GTEST_TESTS OFF CACHE BOOL "Benchmark gtest tests off")
+        set(BENCHMARK_ENABLE_INSTALL OFF CACHE BOOL "Benchmark install off")
+        add_subdirectory(${benchmark_SOURCE_DIR} ${benchmark_BINARY_DIR} EXCLUDE_FROM_ALL)
+    endif()
+
+    mark_as_advanced(
+        BENCHMARK_ENABLE_TESTING BENCHMARK_ENABLE_GTEST_TESTS BENCHMARK_ENABLE_INSTALL
+    )
+endif()
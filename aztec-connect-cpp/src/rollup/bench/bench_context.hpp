@@ -0,0 +1,214 @@
+#pragma once
+#include "../fixtures/test_context.hpp"
+#include "../proofs/rollup/index.hpp"
+#include "../proofs/root_rollup/index.hpp"
+#include "../proofs/root_verifier/index.hpp"
+#include <plonk/proof_system/commitment_scheme/kate_commitment_scheme.hpp>
+#include <memory>
+#include <map>
+
+namespace rollup {
+namespace bench {
+
+using namespace ::rollup::proofs;
+
+/**
+ * The crs path relative to the build directory, as the tests use. `run_rollup_bench` runs from there.
+ */
+constexpr auto CRS_PATH = "../barretenberg/cpp/srs_db/ignition";
+
+/**
+ * Circuit data and proofs shared by the benchmarks, for either real or mock proofs.
+ *
+ * Everything is computed in memory on first use, outside of any timed loop, and kept for the rest of the run, so a
+ * benchmark only pays for the circuits it touches. Proofs are created from the debug random engine against a fresh
+ * world state, so every run proves the same txs.
+ */
+class BenchContext {
+  public:
+    static BenchContext& get(bool mock)
+    {
+        static std::map<bool, std::unique_ptr<BenchContext>> contexts;
+        auto& context = contexts[mock];
+        if (!context) {
+            context.reset(new BenchContext(mock));
+        }
+        return *context;
+    }
+
+    BenchContext(BenchContext const&) = delete;
+    BenchContext& operator=(BenchContext const&) = delete;
+
+    std::shared_ptr<waffle::ReferenceStringFactory> const& srs() { return srs_; }
+
+    join_split::circuit_data const& join_split_circuit_data() { return js_cd_; }
+
+    account::circuit_data const& account_circuit_data() { return account_cd_; }
+
+    claim::circuit_data const& claim_circuit_data() { return claim_cd_; }
+
+    rollup::circuit_data const& tx_rollup_circuit_data(size_t rollup_size)
+    {
+        auto it = tx_rollup_cds_.find(rollup_size);
+        if (it == tx_rollup_cds_.end()) {
+            auto cd = rollup::get_circuit_data(
+                rollup_size, js_cd_, account_cd_, claim_cd_, srs_, "", true, false, false, true, true, mock_);
+            it = tx_rollup_cds_.emplace(rollup_size, cd).first;
+        }
+        return it->second;
+    }
+
+    root_rollup::circuit_data const& root_rollup_circuit_data(size_t rollup_size, size_t num_inner_rollups)
+    {
+        auto key = std::make_pair(rollup_size, num_inner_rollups);
+        auto it = root_rollup_cds_.find(key);
+        if (it == root_rollup_cds_.end()) {
+            auto const& tx_rollup_cd = tx_rollup_circuit_data(rollup_size);
+            auto cd = root_rollup::get_circuit_data(
+                num_inner_rollups, tx_rollup_cd, srs_, "", true, false, false, true, true, mock_);
+            it = root_rollup_cds_.emplace(key, cd).first;
+        }
+        return it->second;
+    }
+
+    root_verifier::circuit_data const& root_verifier_circuit_data(size_t rollup_size, size_t num_inner_rollups)
+    {
+        auto key = std::make_pair(rollup_size, num_inner_rollups);
+        auto it = root_verifier_cds_.find(key);
+        if (it == root_verifier_cds_.end()) {
+            auto const& root_rollup_cd = root_rollup_circuit_data(rollup_size, num_inner_rollups);
+            auto cd = root_verifier::get_circuit_data(
+                root_rollup_cd, srs_, { root_rollup_cd.verification_key }, "", true, false, false, true, true, mock_);
+            it = root_verifier_cds_.emplace(key, cd).first;
+        }
+        return it->second;
+    }
+
+    /**
+     * The first `count` of a series of deposit proofs, all against the empty data tree. Mock proofs carry the same
+     * public inputs as real ones, as rollup_cli's mock mode expects of its inputs.
+     */
+    std::vector<std::vector<uint8_t>> deposit_proofs(size_t count)
+    {
+        while (deposit_proofs_.size() < count) {
+            if (!mock_) {
+                deposit_proofs_.push_back(context_.create_join_split_proof({}, {}, { 100, 50 }, 150));
+                continue;
+            }
+            auto tx = context_.js_tx_factory.create_join_split_tx({}, {}, { 100, 50 }, 150);
+            context_.js_tx_factory.finalise_and_sign_tx(tx, context_.user.owner);
+            join_split::Composer composer(js_cd_.proving_key, js_cd_.verification_key, js_cd_.num_gates);
+            join_split::join_split_circuit(composer, tx);
+            join_split::Composer mock_proof_composer(js_cd_.srs);
+            mock::mock_circuit(mock_proof_composer, composer.get_public_inputs());
+            auto prover = mock_proof_composer.create_unrolled_prover();
+            deposit_proofs_.push_back(prover.construct_proof().proof_data);
+        }
+        return { deposit_proofs_.begin(), deposit_proofs_.begin() + static_cast<std::ptrdiff_t>(count) };
+    }
+
+    /**
+     * A rollup of `num_txs` deposits, ready to be proven by a tx rollup of `rollup_size`.
+     */
+    rollup::rollup_tx get_tx_rollup_tx(size_t rollup_size, size_t num_txs)
+    {
+        fixtures::WorldState world_state;
+        return rollup::create_rollup_tx(world_state, rollup_size, deposit_proofs(num_txs));
+    }
+
+    /**
+     * A root rollup of `num_inner_rollups` full tx rollups of deposits.
+     */
+    root_rollup::root_rollup_tx get_root_rollup_tx(size_t rollup_size, size_t num_inner_rollups)
+    {
+        auto key = std::make_pair(rollup_size, num_inner_rollups);
+        auto it = root_rollup_txs_.find(key);
+        if (it != root_rollup_txs_.end()) {
+            return it->second;
+        }
+        auto const& tx_rollup_cd = tx_rollup_circuit_data(rollup_size);
+        auto proofs = deposit_proofs(rollup_size * num_inner_rollups);
+        fixtures::WorldState world_state;
+        std::vector<std::vector<uint8_t>> rollups_data;
+        for (size_t i = 0; i < num_inner_rollups; ++i) {
+            auto begin = proofs.begin() + static_cast<std::ptrdiff_t>(i * rollup_size);
+            auto end = begin + static_cast<std::ptrdiff_t>(rollup_size);
+            auto rollup = rollup::create_rollup_tx(world_state, rollup_size, { begin, end });
+            auto result = rollup::verify(rollup, tx_rollup_cd);
+            if (!result.verified) {
+                throw_or_abort("Failed to create tx rollup proof for benchmark.");
+            }
+            rollups_data.push_back(result.proof_data);
+        }
+        auto tx = root_rollup::create_root_rollup_tx(
+            world_state, 0, world_state.defi_tree.root(), world_state.defi_tree.get_hash_path(0), rollups_data);
+        return root_rollup_txs_.emplace(key, tx).first->second;
+    }
+
+    root_verifier::root_verifier_tx get_root_verifier_tx(size_t rollup_size, size_t num_inner_rollups)
+    {
+        auto key = std::make_pair(rollup_size, num_inner_rollups);
+        auto it = root_verifier_txs_.find(key);
+        if (it != root_verifier_txs_.end()) {
+            return it->second;
+        }
+        auto tx = get_root_rollup_tx(rollup_size, num_inner_rollups);
+        auto result = root_rollup::verify(tx, root_rollup_circuit_data(rollup_size, num_inner_rollups));
+        if (!result.verified) {
+            throw_or_abort("Failed to create root rollup proof for benchmark.");
+        }
+        return root_verifier_txs_.emplace(key, root_verifier::create_root_verifier_tx(result)).first->second;
+    }
+
+    fixtures::TestContext& test_context() { return context_; }
+
+  private:
+    explicit BenchContext(bool mock)
+        : mock_(mock)
+        , srs_(std::make_shared<waffle::DynamicFileReferenceStringFactory>(CRS_PATH))
+        , js_cd_(join_split::get_circuit_data(srs_, mock))
+        , account_cd_(account::get_circuit_data(srs_, mock))
+        , claim_cd_(claim::get_circuit_data(srs_, mock))
+        , context_(js_cd_, account_cd_, claim_cd_)
+    {}
+
+    bool mock_;
+    std::shared_ptr<waffle::ReferenceStringFactory> srs_;
+    join_split::circuit_data js_cd_;
+    account::circuit_data account_cd_;
+    claim::circuit_data claim_cd_;
+    fixtures::TestContext context_;
+    std::vector<std::vector<uint8_t>> deposit_proofs_;
+    std::map<size_t, rollup::circuit_data> tx_rollup_cds_;
+    std::map<std::pair<size_t, size_t>, root_rollup::circuit_data> root_rollup_cds_;
+    std::map<std::pair<size_t, size_t>, root_verifier::circuit_data> root_verifier_cds_;
+    std::map<std::pair<size_t, size_t>, root_rollup::root_rollup_tx> root_rollup_txs_;
+    std::map<std::pair<size_t, size_t>, root_verifier::root_verifier_tx> root_verifier_txs_;
+};
+
+/**
+ * Verifies a proof of any of the turbo circuits, which are all proven with the unrolled prover, given only its key.
+ */
+inline bool verify_turbo_proof(std::shared_ptr<waffle::verification_key> const& key,
+                               std::vector<uint8_t> const& proof)
+{
+    auto manifest = waffle::TurboComposer::create_unrolled_manifest(key->num_public_inputs);
+    waffle::UnrolledTurboVerifier verifier(key, manifest);
+    verifier.commitment_scheme = std::make_unique<waffle::KateCommitmentScheme<waffle::unrolled_turbo_settings>>();
+    return verifier.verify_proof({ proof });
+}
+
+/**
+ * Verifies a proof of the root verifier circuit, the one verified on chain, given only its key.
+ */
+inline bool verify_standard_proof(std::shared_ptr<waffle::verification_key> const& key,
+                                  std::vector<uint8_t> const& proof)
+{
+    auto manifest = waffle::StandardComposer::create_manifest(key->num_public_inputs);
+    waffle::Verifier verifier(key, manifest);
+    verifier.commitment_scheme = std::make_unique<waffle::KateCommitmentScheme<waffle::standard_settings>>();
+    return verifier.verify_proof({ proof });
+}
+
+} // namespace bench
+} // namespace rollup
@@ -0,0 +1,102 @@
+#include "../fixtures/user_context.hpp"
+#include "../proofs/notes/native/index.hpp"
+#include <benchmark/benchmark.h>
+#include <common/serialize.hpp>
+
+extern "C" {
+void notes__batch_decrypt_notes(uint8_t const* encrypted_notes_buffer,
+                                uint8_t* private_key_buffer,
+                                uint32_t numKeys,
+                                uint8_t* output);
+}
+
+namespace rollup {
+namespace bench {
+namespace {
+
+using namespace benchmark;
+using namespace barretenberg;
+using namespace proofs::notes::native;
+
+constexpr size_t ENCRYPTED_NOTE_LENGTH = 80 + 64;
+constexpr size_t DECRYPTED_NOTE_LENGTH = 73;
+
+auto& engine = numeric::random::get_debug_engine(true);
+fixtures::user_context user = fixtures::create_user_context(&engine);
+
+void value_note_commitment(State& state)
+{
+    value::value_note note = { 100, 0, false, user.owner.public_key, user.note_secret, 0, fr::random_element(&engine) };
+    for (auto _ : state) {
+        DoNotOptimize(note.commit());
+    }
+}
+BENCHMARK(value_note_commitment)->Unit(kMicrosecond);
+
+void value_note_nullifier(State& state)
+{
+    value::value_note note = { 100, 0, false, user.owner.public_key, user.note_secret, 0, fr::random_element(&engine) };
+    auto commitment = note.commit();
+    for (auto _ : state) {
+        DoNotOptimize(compute_nullifier(commitment, user.owner.private_key, true));
+    }
+}
+BENCHMARK(value_note_nullifier)->Unit(kMicrosecond);
+
+void account_note_commitment(State& state)
+{
+    account::account_note note = { user.alias_hash, user.owner.public_key, user.signing_keys[0].public_key };
+    for (auto _ : state) {
+        DoNotOptimize(note.commit());
+    }
+}
+BENCHMARK(account_note_commitment)->Unit(kMicrosecond);
+
+void claim_note_commitment(State& state)
+{
+    auto partial_state = value::create_partial_commitment(user.note_secret, user.owner.public_key, 0, 0);
+    claim::claim_note note = { 10, 0, 0, 0, partial_state, fr::random_element(&engine) };
+    for (auto _ : state) {
+        DoNotOptimize(note.commit());
+    }
+}
+BENCHMARK(claim_note_commitment)->Unit(kMicrosecond);
+
+void defi_interaction_note_commitment(State& state)
+{
+    defi_interaction::note note = { 0, 0, 100, 200, 300, true };
+    for (auto _ : state) {
+        DoNotOptimize(note.commit());
+    }
+}
+BENCHMARK(defi_interaction_note_commitment)->Unit(kMicrosecond);
+
+/**
+ * Decrypts notes as the sdk does on sync. The cost doesn't depend on whether a note decrypts (the shared secret is
+ * derived and the ciphertext decrypted either way), so random ciphertexts under random ephemeral keys do.
+ */
+void notes__batch_decrypt_notes(State& state)
+{
+    auto num_notes = static_cast<size_t>(state.range(0));
+    std::vector<uint8_t> encrypted_notes;
+    encrypted_notes.reserve(num_notes * ENCRYPTED_NOTE_LENGTH);
+    for (size_t i = 0; i < num_notes; ++i) {
+        for (size_t j = 0; j < 80; ++j) {
+            encrypted_notes.push_back(engine.get_random_uint8());
+        }
+        write(encrypted_notes, fixtures::create_key_pair(&engine).public_key);
+    }
+    auto private_key = to_buffer(user.owner.private_key);
+    std::vector<uint8_t> output(num_notes * DECRYPTED_NOTE_LENGTH);
+    for (auto _ : state) {
+        ::notes__batch_decrypt_notes(
+            encrypted_notes.data(), private_key.data(), static_cast<uint32_t>(num_notes), output.data());
+        ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(notes__batch_decrypt_notes)->ArgName("notes")->RangeMultiplier(8)->Range(1, 1 << 12)->Unit(kMillisecond);
+
+} // namespace
+} // namespace bench
+} // namespace rollup
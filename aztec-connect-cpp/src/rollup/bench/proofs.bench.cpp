@@ -0,0 +1,115 @@
+#include "bench_context.hpp"
+#include <benchmark/benchmark.h>
+
+namespace rollup {
+namespace bench {
+namespace {
+
+using namespace benchmark;
+using namespace notes::native;
+
+join_split::join_split_tx create_join_split_tx(BenchContext& bench)
+{
+    auto& context = bench.test_context();
+    auto tx = context.js_tx_factory.create_join_split_tx({}, {}, { 100, 50 }, 150);
+    context.js_tx_factory.finalise_and_sign_tx(tx, context.user.owner);
+    return tx;
+}
+
+account::account_tx create_account_tx(BenchContext& bench)
+{
+    return bench.test_context().account_tx_factory.create_new_account_tx(0);
+}
+
+/**
+ * Claims a deposit of 10 from an interaction that turned 100 into 200 and 300, as the claim tests do. The notes go in
+ * a world state of their own, so the shared one stays empty for the deposit proofs.
+ */
+claim::claim_tx create_claim_tx(BenchContext& bench)
+{
+    auto const& user = bench.test_context().user;
+    fixtures::WorldState world_state;
+    auto partial_state = value::create_partial_commitment(user.note_secret, user.owner.public_key, 0, 0);
+    claim::claim_note claim_note = { 10, 0, 0, 0, partial_state, 1 };
+    defi_interaction::note interaction_note = { 0, 0, 100, 200, 300, true };
+    world_state.insert_data_entry(0, claim_note.commit(), claim_note.input_nullifier);
+    world_state.add_defi_notes({ interaction_note }, 0);
+
+    claim::ClaimTxFactory<fixtures::WorldState> claim_tx_factory(world_state, user);
+    return claim_tx_factory.create_claim_tx(world_state.defi_tree.root(), 0, 0, claim_note, interaction_note);
+}
+
+void join_split_prove(State& state)
+{
+    auto& bench = BenchContext::get(false);
+    auto const& cd = bench.join_split_circuit_data();
+    auto tx = create_join_split_tx(bench);
+    for (auto _ : state) {
+        DoNotOptimize(join_split::create_proof(tx, cd));
+    }
+}
+BENCHMARK(join_split_prove)->Unit(kMillisecond);
+
+void join_split_verify(State& state)
+{
+    auto& bench = BenchContext::get(false);
+    auto const& cd = bench.join_split_circuit_data();
+    auto proof = join_split::create_proof(create_join_split_tx(bench), cd);
+    for (auto _ : state) {
+        DoNotOptimize(verify_turbo_proof(cd.verification_key, proof));
+    }
+}
+BENCHMARK(join_split_verify)->Unit(kMillisecond);
+
+void account_prove(State& state)
+{
+    auto& bench = BenchContext::get(false);
+    auto const& cd = bench.account_circuit_data();
+    auto tx = create_account_tx(bench);
+    auto const& signer = bench.test_context().user.owner;
+    for (auto _ : state) {
+        // Proving signs the tx in place.
+        auto signed_tx = tx;
+        DoNotOptimize(account::create_proof(signed_tx, signer, cd));
+    }
+}
+BENCHMARK(account_prove)->Unit(kMillisecond);
+
+void account_verify(State& state)
+{
+    auto& bench = BenchContext::get(false);
+    auto const& cd = bench.account_circuit_data();
+    auto tx = create_account_tx(bench);
+    auto proof = account::create_proof(tx, bench.test_context().user.owner, cd);
+    for (auto _ : state) {
+        DoNotOptimize(verify_turbo_proof(cd.verification_key, proof));
+    }
+}
+BENCHMARK(account_verify)->Unit(kMillisecond);
+
+void claim_prove(State& state)
+{
+    auto& bench = BenchContext::get(false);
+    auto const& cd = bench.claim_circuit_data();
+    auto tx = create_claim_tx(bench);
+    for (auto _ : state) {
+        DoNotOptimize(claim::create_proof(tx, cd));
+    }
+}
+BENCHMARK(claim_prove)->Unit(kMillisecond);
+
+void claim_verify(State& state)
+{
+    auto& bench = BenchContext::get(false);
+    auto const& cd = bench.claim_circuit_data();
+    auto tx = create_claim_tx(bench);
+    auto proof = claim::create_proof(tx, cd);
+    for (auto _ : state) {
+        DoNotOptimize(verify_turbo_proof(cd.verification_key, proof));
+    }
+}
+BENCHMARK(claim_verify)->Unit(kMillisecond);
+
+} // namespace
+} // namespace bench
+} // namespace rollup
@@ -0,0 +1,151 @@
+#include "bench_context.hpp"
+#include <benchmark/benchmark.h>
+
+namespace rollup {
+namespace bench {
+namespace {
+
+using namespace benchmark;
+
+constexpr int64_t MAX_TX_ROLLUP_SIZE = 32;
+
+/**
+ * Tx rollups of every power of two size up to the largest, with mock proofs (all the non proving work) then real ones.
+ */
+void tx_rollup_args(internal::Benchmark* b)
+{
+    b->ArgNames({ "txs", "mock" });
+    for (int64_t mock : { 1, 0 }) {
+        for (int64_t txs = 1; txs <= MAX_TX_ROLLUP_SIZE; txs *= 2) {
+            b->Args({ txs, mock });
+        }
+    }
+}
+
+/**
+ * Root rollups of as many inner rollups as each inner rollup has txs, so each doubling quadruples the txs.
+ */
+void root_rollup_args(internal::Benchmark* b)
+{
+    b->ArgNames({ "txs", "inner_rollups", "mock" });
+    for (int64_t mock : { 1, 0 }) {
+        for (int64_t size : { 1, 2, 4 }) {
+            b->Args({ size, size, mock });
+        }
+    }
+}
+
+void create_rollup_tx(State& state)
+{
+    auto num_txs = static_cast<size_t>(state.range(0));
+    // The proofs' contents don't matter here, only their public inputs, so mock proofs do.
+    auto proofs = BenchContext::get(true).deposit_proofs(num_txs);
+    for (auto _ : state) {
+        state.PauseTiming();
+        fixtures::WorldState world_state;
+        state.ResumeTiming();
+        DoNotOptimize(rollup::create_rollup_tx(world_state, num_txs, proofs));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(create_rollup_tx)->ArgName("txs")->RangeMultiplier(2)->Range(1, MAX_TX_ROLLUP_SIZE);
+
+void tx_rollup_prove(State& state)
+{
+    auto num_txs = static_cast<size_t>(state.range(0));
+    auto& bench = BenchContext::get(state.range(1) != 0);
+    auto const& cd = bench.tx_rollup_circuit_data(num_txs);
+    auto tx = bench.get_tx_rollup_tx(num_txs, num_txs);
+    for (auto _ : state) {
+        // Proving pads the tx in place.
+        auto padded_tx = tx;
+        auto result = rollup::verify(padded_tx, cd);
+        if (!result.verified) {
+            state.SkipWithError("Tx rollup proof failed.");
+            break;
+        }
+    }
+}
+BENCHMARK(tx_rollup_prove)->Apply(tx_rollup_args)->Unit(kMillisecond);
+
+void tx_rollup_verify(State& state)
+{
+    auto num_txs = static_cast<size_t>(state.range(0));
+    auto& bench = BenchContext::get(state.range(1) != 0);
+    auto const& cd = bench.tx_rollup_circuit_data(num_txs);
+    auto tx = bench.get_tx_rollup_tx(num_txs, num_txs);
+    auto proof = rollup::verify(tx, cd).proof_data;
+    for (auto _ : state) {
+        DoNotOptimize(verify_turbo_proof(cd.verification_key, proof));
+    }
+}
+BENCHMARK(tx_rollup_verify)->Apply(tx_rollup_args)->Unit(kMillisecond);
+
+void root_rollup_prove(State& state)
+{
+    auto rollup_size = static_cast<size_t>(state.range(0));
+    auto num_inner_rollups = static_cast<size_t>(state.range(1));
+    auto& bench = BenchContext::get(state.range(2) != 0);
+    auto const& cd = bench.root_rollup_circuit_data(rollup_size, num_inner_rollups);
+    auto tx = bench.get_root_rollup_tx(rollup_size, num_inner_rollups);
+    for (auto _ : state) {
+        auto padded_tx = tx;
+        auto result = root_rollup::verify(padded_tx, cd);
+        if (!result.verified) {
+            state.SkipWithError("Root rollup proof failed.");
+            break;
+        }
+    }
+}
+BENCHMARK(root_rollup_prove)->Apply(root_rollup_args)->Unit(kMillisecond);
+
+void root_rollup_verify(State& state)
+{
+    auto rollup_size = static_cast<size_t>(state.range(0));
+    auto num_inner_rollups = static_cast<size_t>(state.range(1));
+    auto& bench = BenchContext::get(state.range(2) != 0);
+    auto const& cd = bench.root_rollup_circuit_data(rollup_size, num_inner_rollups);
+    auto tx = bench.get_root_rollup_tx(rollup_size, num_inner_rollups);
+    auto proof = root_rollup::verify(tx, cd).proof_data;
+    for (auto _ : state) {
+        DoNotOptimize(verify_turbo_proof(cd.verification_key, proof));
+    }
+}
+BENCHMARK(root_rollup_verify)->Apply(root_rollup_args)->Unit(kMillisecond);
+
+void root_verifier_prove(State& state)
+{
+    auto rollup_size = static_cast<size_t>(state.range(0));
+    auto num_inner_rollups = static_cast<size_t>(state.range(1));
+    auto& bench = BenchContext::get(state.range(2) != 0);
+    auto const& root_rollup_cd = bench.root_rollup_circuit_data(rollup_size, num_inner_rollups);
+    auto const& cd = bench.root_verifier_circuit_data(rollup_size, num_inner_rollups);
+    auto tx = bench.get_root_verifier_tx(rollup_size, num_inner_rollups);
+    for (auto _ : state) {
+        auto result = root_verifier::verify(tx, cd, root_rollup_cd);
+        if (!result.verified) {
+            state.SkipWithError("Root verifier proof failed.");
+            break;
+        }
+    }
+}
+BENCHMARK(root_verifier_prove)->Apply(root_rollup_args)->Unit(kMillisecond);
+
+void root_verifier_verify(State& state)
+{
+    auto rollup_size = static_cast<size_t>(state.range(0));
+    auto num_inner_rollups = static_cast<size_t>(state.range(1));
+    auto& bench = BenchContext::get(state.range(2) != 0);
+    auto const& root_rollup_cd = bench.root_rollup_circuit_data(rollup_size, num_inner_rollups);
+    auto const& cd = bench.root_verifier_circuit_data(rollup_size, num_inner_rollups);
+    auto tx = bench.get_root_verifier_tx(rollup_size, num_inner_rollups);
+    auto proof = root_verifier::verify(tx, cd, root_rollup_cd).proof_data;
+    for (auto _ : state) {
+        DoNotOptimize(verify_standard_proof(cd.verification_key, proof));
+    }
+}
+BENCHMARK(root_verifier_verify)->Apply(root_rollup_args)->Unit(kMillisecond);
+
+} // namespace
+} // namespace bench
+} // namespace rollup
@@ -0,0 +1,104 @@
+#include "../fixtures/test_context.hpp"
+#include <benchmark/benchmark.h>
+
+namespace rollup {
+namespace bench {
+namespace {
+
+using namespace benchmark;
+using namespace barretenberg;
+
+std::vector<fr> random_values(size_t count)
+{
+    auto& engine = numeric::random::get_debug_engine(true);
+    std::vector<fr> values(count);
+    for (auto& value : values) {
+        value = fr::random_element(&engine);
+    }
+    return values;
+}
+
+/**
+ * A world state with `size` notes in the data tree and `size` nullifiers in the nullifier tree.
+ */
+std::unique_ptr<fixtures::WorldState> create_world_state(size_t size)
+{
+    auto world_state = std::make_unique<fixtures::WorldState>();
+    auto values = random_values(size);
+    for (size_t i = 0; i < size; ++i) {
+        world_state->insert_data_entry(i, values[i], 0);
+        world_state->nullify(uint256_t(values[i]));
+    }
+    return world_state;
+}
+
+void world_state_insert_data_entry(State& state)
+{
+    auto values = random_values(static_cast<size_t>(state.max_iterations));
+    fixtures::WorldState world_state;
+    size_t index = 0;
+    for (auto _ : state) {
+        world_state.insert_data_entry(index, values[index], 0);
+        ++index;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(world_state_insert_data_entry)->Unit(kMicrosecond);
+
+void world_state_nullify(State& state)
+{
+    auto values = random_values(static_cast<size_t>(state.max_iterations));
+    fixtures::WorldState world_state;
+    size_t index = 0;
+    for (auto _ : state) {
+        world_state.nullify(uint256_t(values[index++]));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(world_state_nullify)->Unit(kMicrosecond);
+
+void world_state_update_root_tree(State& state)
+{
+    fixtures::WorldState world_state;
+    for (auto _ : state) {
+        world_state.update_root_tree_with_data_root();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(world_state_update_root_tree)->Unit(kMicrosecond);
+
+void world_state_data_path(State& state)
+{
+    auto size = static_cast<size_t>(state.range(0));
+    auto world_state = create_world_state(size);
+    size_t index = 0;
+    for (auto _ : state) {
+        DoNotOptimize(world_state->data_tree.get_hash_path(index));
+        index = (index + 1) % size;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(world_state_data_path)->ArgName("notes")->RangeMultiplier(4)->Range(1 << 8, 1 << 14)->Unit(kMicrosecond);
+
+void world_state_null_path(State& state)
+{
+    auto size = static_cast<size_t>(state.range(0));
+    auto world_state = create_world_state(size);
+    // The same values the world state was built from, so the paths lead to nullified leaves.
+    auto nullifiers = random_values(size);
+    size_t index = 0;
+    for (auto _ : state) {
+        DoNotOptimize(world_state->null_tree.get_hash_path(uint256_t(nullifiers[index])));
+        index = (index + 1) % size;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(world_state_null_path)
+    ->ArgName("nullifiers")
+    ->RangeMultiplier(4)
+    ->Range(1 << 8, 1 << 14)
+    ->Unit(kMicrosecond);
+
+} // namespace
+} // namespace bench
+} // namespace rollup
@@ -0,0 +1,123 @@
+#pragma once
+#include "put.hpp"
+#include "tree_levels.hpp"
+#include "world_state_view.hpp"
+#include <common/throw_or_abort.hpp>
+#include <stdlib/merkle_tree/merkle_tree.hpp>
+#include <algorithm>
+#include <chrono>
+
+namespace bulk_load {
+
+using namespace barretenberg;
+using namespace tree_levels;
+using plonk::stdlib::merkle_tree::get_hash_path_root;
+
+/**
+ * Reads a stream of leaves in the PUT request format (tree id, index, value) until EOF, and splits them by tree.
+ * Leaves must be sorted by tree and index. Where an index is repeated, the last value wins, as it would on replay.
+ */
+inline std::array<std::vector<node>, 4> read_leaves(std::istream& is)
+{
+    std::array<std::vector<node>, 4> leaves;
+    uint8_t last_tree_id = 0;
+    while (is.peek() != std::char_traits<char>::eof()) {
+        PutRequest put_request;
+        read(is, put_request);
+        if (!is.good()) {
+            throw_or_abort("Truncated leaf stream.");
+        }
+
+        auto tree_id = put_request.tree_id;
+        if (tree_id >= leaves.size() || tree_id < last_tree_id) {
+            throw_or_abort(format("Leaf stream not sorted by tree at ", put_request));
+        }
+        if (put_request.index.get_msb() >= TREE_DEPTHS[tree_id]) {
+            throw_or_abort(format("Leaf index out of range at ", put_request));
+        }
+
+        auto& tree_leaves = leaves[tree_id];
+        if (tree_id == last_tree_id && !tree_leaves.empty() && put_request.index <= tree_leaves.back().index) {
+            if (put_request.index < tree_leaves.back().index) {
+                throw_or_abort(format("Leaf stream not sorted by index at ", put_request));
+            }
+            tree_leaves.back().value = put_request.value;
+            continue;
+        }
+        tree_leaves.push_back({ put_request.index, put_request.value });
+        last_tree_id = tree_id;
+    }
+    return leaves;
+}
+
+/**
+ * Checks a tree reads back as built.
+ */
+template <typename Store>
+void verify_tree(WorldStateView<Store>& view, uint8_t tree_id, fr const& root, std::vector<node> const& leaves)
+{
+    if (view.root(tree_id) != root) {
+        throw_or_abort(format("Tree ", (int)tree_id, " root mismatch after load."));
+    }
+    if (leaves.empty()) {
+        return;
+    }
+    auto const& last = leaves.back();
+    auto path = view.get_hash_path(tree_id, last.index);
+    auto leaf = last.index & 1 ? path[0].second : path[0].first;
+    if (leaf != last.value || get_hash_path_root(path) != root) {
+        throw_or_abort(format("Tree ", (int)tree_id, " hash path mismatch after load."));
+    }
+}
+
+template <typename Store> void check_empty(Store& store)
+{
+    WorldStateView<Store> existing(store);
+    for (uint8_t tree_id = 0; tree_id < TREE_DEPTHS.size(); ++tree_id) {
+        if (existing.size(tree_id) != 0) {
+            throw_or_abort("Load requires an empty database.");
+        }
+    }
+    store.rollback();
+}
+
+/**
+ * Builds all four trees of an empty database from a leaf stream.
+ */
+template <typename Store> void load(Store& store, std::istream& is)
+{
+    check_empty(store);
+
+    auto start = std::chrono::steady_clock::now();
+    auto leaves = read_leaves(is);
+    std::cerr << "Read leaves in "
+              << std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now() - start).count()
+              << "s" << std::endl;
+
+    std::array<fr, 4> roots;
+    for (uint8_t tree_id = 0; tree_id < TREE_DEPTHS.size(); ++tree_id) {
+        start = std::chrono::steady_clock::now();
+        uint256_t size = leaves[tree_id].empty() ? 0 : leaves[tree_id].back().index + 1;
+        // Zero leaves are empty, so aren't part of the tree.
+        auto& tree_leaves = leaves[tree_id];
+        tree_leaves.erase(std::remove_if(tree_leaves.begin(),
+                                         tree_leaves.end(),
+                                         [](node const& leaf) { return leaf.value == fr::zero(); }),
+                          tree_leaves.end());
+        auto levels = build_levels(TREE_DEPTHS[tree_id], tree_leaves);
+        auto tree = levels.view();
+        tree.write_to(store, tree_id, size);
+        roots[tree_id] = tree.root();
+        std::cerr << "Tree " << (int)tree_id << ": " << tree_leaves.size() << " leaves, root " << roots[tree_id]
+                  << " in "
+                  << std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now() - start).count()
+                  << "s" << std::endl;
+    }
+
+    WorldStateView<Store> loaded(store);
+    for (uint8_t tree_id = 0; tree_id < TREE_DEPTHS.size(); ++tree_id) {
+        verify_tree(loaded, tree_id, roots[tree_id], leaves[tree_id]);
+    }
+}
+
+} // namespace bulk_load
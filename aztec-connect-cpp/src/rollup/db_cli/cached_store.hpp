@@ -0,0 +1,151 @@
+#pragma once
+#include <stdlib/merkle_tree/merkle_tree.hpp>
+#include <common/serialize.hpp>
+#include <rollup/constants.hpp>
+#include <cstring>
+#include <list>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+struct NodeCacheStats {
+    // Node reads served from the cache.
+    uint64_t hits = 0;
+    // Node reads of an empty subtree, which is never stored, answered without reading the store.
+    uint64_t empty_hits = 0;
+    // Node reads that went to the store.
+    uint64_t misses = 0;
+};
+
+/**
+ * Caches tree node reads over the database store.
+ *
+ * Every path read or update passes through the top levels of its tree, so a least recently used cache of nodes keeps
+ * those levels in memory, without needing to know which level a node is at (nodes are keyed only by hash). Most nodes
+ * never change once written under their 32 byte hash, but a stump's hash doesn't cover the high bits of its leaf
+ * index, so a stump can be overwritten in place. Nodes written since the last commit are therefore dropped from the
+ * cache on rollback, so a rolled back write is never served. Other keys are mutable, so are always read through.
+ *
+ * Empty subtrees are never stored, and most of a nullifier tree path lies in them. Their hashes are known up front for
+ * every height, so reads of them are answered as absent without going to the store.
+ */
+template <typename Parent> class CachedStore {
+  public:
+    using Key = std::vector<uint8_t>;
+    using Value = std::vector<uint8_t>;
+
+    CachedStore(Parent& parent, size_t capacity)
+        : parent_(parent)
+        , capacity_(capacity)
+    {
+        auto zero_hash = barretenberg::fr::zero();
+        empty_nodes_.insert(to_buffer(zero_hash));
+        for (size_t height = 0; height < rollup::NULL_TREE_DEPTH; ++height) {
+            zero_hash = plonk::stdlib::merkle_tree::compress_native(zero_hash, zero_hash);
+            empty_nodes_.insert(to_buffer(zero_hash));
+        }
+    }
+
+    CachedStore(CachedStore const&) = delete;
+    CachedStore& operator=(CachedStore const&) = delete;
+
+    bool get(Key const& key, Value& value)
+    {
+        if (key.size() != 32) {
+            return parent_.get(key, value);
+        }
+        if (empty_nodes_.count(key)) {
+            ++stats_.empty_hits;
+            return false;
+        }
+        auto it = index_.find(key);
+        if (it != index_.end()) {
+            ++stats_.hits;
+            nodes_.splice(nodes_.begin(), nodes_, it->second);
+            value = it->second->second;
+            return true;
+        }
+        ++stats_.misses;
+        if (!parent_.get(key, value)) {
+            return false;
+        }
+        insert(key, value);
+        return true;
+    }
+
+    void put(Key const& key, Value const& value)
+    {
+        // Written nodes are those on the paths being updated, the likeliest to be read next.
+        if (key.size() == 32) {
+            insert(key, value);
+            uncommitted_.insert(key);
+        }
+        parent_.put(key, value);
+    }
+
+    void del(Key const& key) { parent_.del(key); }
+
+    void commit()
+    {
+        parent_.commit();
+        uncommitted_.clear();
+    }
+
+    void rollback()
+    {
+        parent_.rollback();
+        for (auto const& key : uncommitted_) {
+            auto it = index_.find(key);
+            if (it != index_.end()) {
+                nodes_.erase(it->second);
+                index_.erase(it);
+            }
+        }
+        uncommitted_.clear();
+    }
+
+    NodeCacheStats const& stats() const { return stats_; }
+
+    size_t size() const { return nodes_.size(); }
+
+  private:
+    struct Hash {
+        size_t operator()(Key const& key) const
+        {
+            // Keys are hashes, so their leading bytes are well distributed.
+            size_t hash = 0;
+            std::memcpy(&hash, key.data(), std::min(sizeof(hash), key.size()));
+            return hash;
+        }
+    };
+
+    void insert(Key const& key, Value const& value)
+    {
+        if (capacity_ == 0) {
+            return;
+        }
+        auto it = index_.find(key);
+        if (it != index_.end()) {
+            // A stump's hash doesn't cover the high bits of its leaf index, so the latest write is kept.
+            it->second->second = value;
+            nodes_.splice(nodes_.begin(), nodes_, it->second);
+            return;
+        }
+        nodes_.emplace_front(key, value);
+        index_[key] = nodes_.begin();
+        if (nodes_.size() > capacity_) {
+            index_.erase(nodes_.back().first);
+            nodes_.pop_back();
+        }
+    }
+
+    Parent& parent_;
+    size_t capacity_;
+    std::unordered_set<Key, Hash> empty_nodes_;
+    // Most recently used first.
+    std::list<std::pair<Key, Value>> nodes_;
+    std::unordered_map<Key, typename std::list<std::pair<Key, Value>>::iterator, Hash> index_;
+    // Nodes written since the last commit.
+    std::unordered_set<Key, Hash> uncommitted_;
+    NodeCacheStats stats_;
+};
@@ -0,0 +1,44 @@
+#pragma once
+#include <cstdint>
+
+/**
+ * The commands db_cli reads off stdin, each a single byte followed by its request.
+ */
+enum Command {
+    GET,
+    PUT,
+    COMMIT,
+    ROLLBACK,
+    GETPATH,
+    BATCH_PUT,
+    GET_RANGE,
+    FORK,
+    SELECT,
+    MERGE,
+    DROP,
+    NULLIFIERS_EXIST,
+    FIND_LEAF_INDICES,
+    GETPATH_AT,
+    PERSISTED,
+    STATS,
+};
+
+inline char const* command_name(uint8_t command)
+{
+    // In the order of the commands.
+    static char const* const names[] = {
+        "GET",    "PUT",   "COMMIT", "ROLLBACK",         "GETPATH",           "BATCH_PUT",  "GET_RANGE", "FORK",
+        "SELECT", "MERGE", "DROP",   "NULLIFIERS_EXIST", "FIND_LEAF_INDICES", "GETPATH_AT", "PERSISTED", "STATS",
+    };
+    return command <= STATS ? names[command] : "UNKNOWN";
+}
+
+/**
+ * The ids requests address the trees by.
+ */
+enum TreeId : uint8_t {
+    DATA_TREE,
+    NULL_TREE,
+    ROOT_TREE,
+    DEFI_TREE,
+};
@@ -0,0 +1,35 @@
+#pragma once
+#include <common/serialize.hpp>
+#include <ecc/curves/bn254/fr.hpp>
+#include <optional>
+
+struct FindLeafIndicesRequest {
+    uint8_t tree_id;
+    std::vector<barretenberg::fr> values;
+};
+
+struct FindLeafIndicesResponse {
+    std::vector<std::optional<uint256_t>> indices;
+};
+
+void read(std::istream& s, FindLeafIndicesRequest& r)
+{
+    read(s, r.tree_id);
+    read(s, r.values);
+}
+
+void write(std::ostream& s, FindLeafIndicesResponse const& r)
+{
+    // Each index is preceded by whether it was found. An index not found is written as 0.
+    write(s, static_cast<uint32_t>(r.indices.size()));
+    for (auto const& index : r.indices) {
+        write(s, static_cast<uint8_t>(index.has_value()));
+        write(s, index.value_or(uint256_t(0)));
+    }
+}
+
+std::ostream& operator<<(std::ostream& os, FindLeafIndicesRequest const& find_leaf_indices_request)
+{
+    return os << "FIND_LEAF_INDICES (tree:" << (int)find_leaf_indices_request.tree_id
+              << " count:" << find_leaf_indices_request.values.size() << ")";
+}
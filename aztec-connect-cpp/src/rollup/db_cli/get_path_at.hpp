@@ -0,0 +1,36 @@
+#pragma once
+#include <common/serialize.hpp>
+#include <stdlib/merkle_tree/hash_path.hpp>
+#include <optional>
+
+struct GetPathAtRequest {
+    uint8_t tree_id;
+    uint32_t version;
+    uint256_t index;
+};
+
+struct GetPathAtResponse {
+    std::optional<plonk::stdlib::merkle_tree::fr_hash_path> path;
+};
+
+void read(std::istream& s, GetPathAtRequest& r)
+{
+    read(s, r.tree_id);
+    read(s, r.version);
+    read(s, r.index);
+}
+
+void write(std::ostream& s, GetPathAtResponse const& r)
+{
+    // Whether the version is still held, then the path if so.
+    write(s, static_cast<uint8_t>(r.path.has_value()));
+    if (r.path) {
+        write(s, *r.path);
+    }
+}
+
+std::ostream& operator<<(std::ostream& os, GetPathAtRequest const& get_path_at_request)
+{
+    return os << "GETPATH_AT (tree:" << (int)get_path_at_request.tree_id << " version:" << get_path_at_request.version
+              << " index:" << get_path_at_request.index << ")";
+}
@@ -0,0 +1,22 @@
+#pragma once
+#include <common/serialize.hpp>
+#include <ecc/curves/bn254/fr.hpp>
+
+struct GetRangeRequest {
+    uint8_t tree_id;
+    uint256_t start;
+    uint32_t count;
+};
+
+void read(std::istream& s, GetRangeRequest& r)
+{
+    read(s, r.tree_id);
+    read(s, r.start);
+    read(s, r.count);
+}
+
+std::ostream& operator<<(std::ostream& os, GetRangeRequest const& get_range_request)
+{
+    return os << "GET_RANGE (tree:" << (int)get_range_request.tree_id << " start:" << get_range_request.start
+              << " count:" << get_range_request.count << ")";
+}
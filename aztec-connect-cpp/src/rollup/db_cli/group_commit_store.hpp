@@ -0,0 +1,298 @@
+#pragma once
+#include <common/serialize.hpp>
+#include <common/throw_or_abort.hpp>
+#include <condition_variable>
+#include <cerrno>
+#include <deque>
+#include <fcntl.h>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+/**
+ * Holds writes in memory until `commit`, then persists them to the database store.
+ *
+ * In synchronous mode a commit writes the batch to the database before returning, as committing the database store
+ * directly does. In asynchronous mode a commit appends the batch to a write ahead log, queues it, and returns straight
+ * away: reads see committed batches from memory until a background thread has written them to the database. The
+ * database records the number of the last batch it holds, so on open any logged batches after it are replayed.
+ *
+ * Each logged batch is synced to disk (fdatasync) before the commit returns, so no acknowledged commit is lost to a
+ * crash, of the process or of the machine, while it's only in the log. The log is truncated once the database holds
+ * every batch, and the database's own writes aren't synced, so from then on commits are exactly as durable as in
+ * synchronous mode: they survive the process crashing, but not necessarily the machine.
+ *
+ * Log records are: payload length (uint32), commit number (uint64), then the batch's writes, each a flag (1 for put, 0
+ * for delete), the key and, for puts, the value.
+ */
+template <typename Parent> class GroupCommitStore {
+  public:
+    using Key = std::vector<uint8_t>;
+    using Value = std::vector<uint8_t>;
+    using Batch = std::map<Key, std::optional<Value>>;
+
+    GroupCommitStore(Parent& parent, std::string const& log_path, bool async)
+        : parent_(parent)
+        , log_path_(log_path)
+        , async_(async)
+    {
+        Value data;
+        if (parent_.get(persisted_key(), data)) {
+            persisted_ = from_buffer<uint64_t>(data);
+        }
+        recover();
+        committed_ = persisted_;
+        if (async_) {
+            log_fd_ = ::open(log_path_.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+            if (log_fd_ < 0) {
+                throw_or_abort(format("Failed to open commit log ", log_path_));
+            }
+            writer_ = std::thread([this]() { write_batches(); });
+        }
+    }
+
+    GroupCommitStore(GroupCommitStore const&) = delete;
+    GroupCommitStore& operator=(GroupCommitStore const&) = delete;
+
+    ~GroupCommitStore()
+    {
+        if (writer_.joinable()) {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                stopping_ = true;
+            }
+            queued_.notify_one();
+            writer_.join();
+        }
+        if (log_fd_ >= 0) {
+            ::close(log_fd_);
+        }
+    }
+
+    bool get(Key const& key, Value& value)
+    {
+        if (auto found = find(writes_, key)) {
+            return read_value(*found, value);
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (auto it = pending_.rbegin(); it != pending_.rend(); ++it) {
+                if (auto found = find(it->second, key)) {
+                    return read_value(*found, value);
+                }
+            }
+        }
+        // A batch leaves the queue only once it's in the database, so a key not found queued is found here.
+        std::lock_guard<std::mutex> lock(database_mutex_);
+        return parent_.get(key, value);
+    }
+
+    void put(Key const& key, Value const& value) { writes_[key] = value; }
+
+    void del(Key const& key) { writes_[key] = std::nullopt; }
+
+    void commit()
+    {
+        if (writes_.empty()) {
+            return;
+        }
+        auto number = ++committed_;
+        if (!async_) {
+            apply(number, writes_);
+            persisted_ = number;
+            writes_.clear();
+            return;
+        }
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        // Batches already in the database don't need replaying, so the log only grows while the writer is behind.
+        if (pending_.empty() && (::ftruncate(log_fd_, 0) != 0 || ::lseek(log_fd_, 0, SEEK_SET) != 0)) {
+            throw_or_abort(format("Failed to truncate commit log ", log_path_));
+        }
+        lock.unlock();
+        append_to_log(number, writes_);
+
+        lock.lock();
+        pending_.emplace_back(number, std::move(writes_));
+        lock.unlock();
+        writes_.clear();
+        queued_.notify_one();
+    }
+
+    void rollback() { writes_.clear(); }
+
+    /**
+     * The number of the last commit, and of the last commit the database holds. Waits for the database to catch up,
+     * if asked.
+     */
+    std::pair<uint64_t, uint64_t> watermarks(bool wait)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (wait) {
+            persisted_changed_.wait(lock, [&]() { return pending_.empty(); });
+        }
+        return { committed_, persisted_ };
+    }
+
+  private:
+    static Key persisted_key() { return { 'P' }; }
+
+    static std::optional<std::optional<Value>> find(Batch const& batch, Key const& key)
+    {
+        auto it = batch.find(key);
+        if (it == batch.end()) {
+            return std::nullopt;
+        }
+        return it->second;
+    }
+
+    static bool read_value(std::optional<Value> const& found, Value& value)
+    {
+        if (!found) {
+            return false;
+        }
+        value = *found;
+        return true;
+    }
+
+    /**
+     * Writes a batch, and its number, to the database.
+     */
+    void apply(uint64_t number, Batch const& batch)
+    {
+        for (auto const& [key, value] : batch) {
+            if (value) {
+                parent_.put(key, *value);
+            } else {
+                parent_.del(key);
+            }
+        }
+        parent_.put(persisted_key(), to_buffer(number));
+        parent_.commit();
+    }
+
+    void write_batches()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true) {
+            queued_.wait(lock, [&]() { return stopping_ || !pending_.empty(); });
+            if (pending_.empty()) {
+                return;
+            }
+            // The front batch stays queued, so reads still find it while it's written. Queued batches are never
+            // modified, and references to them survive later batches being queued.
+            auto const& [number, batch] = pending_.front();
+            lock.unlock();
+            {
+                std::lock_guard<std::mutex> database_lock(database_mutex_);
+                apply(number, batch);
+            }
+            lock.lock();
+            persisted_ = number;
+            pending_.pop_front();
+            persisted_changed_.notify_all();
+        }
+    }
+
+    void append_to_log(uint64_t number, Batch const& batch)
+    {
+        std::vector<uint8_t> record;
+        write(record, number);
+        for (auto const& [key, value] : batch) {
+            write(record, static_cast<uint8_t>(value.has_value()));
+            write(record, key);
+            if (value) {
+                write(record, *value);
+            }
+        }
+        std::vector<uint8_t> data;
+        write(data, static_cast<uint32_t>(record.size()));
+        data.insert(data.end(), record.begin(), record.end());
+        for (size_t written = 0; written < data.size();) {
+            auto n = ::write(log_fd_, data.data() + written, data.size() - written);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n < 0) {
+                throw_or_abort(format("Failed to write commit log ", log_path_));
+            }
+            written += static_cast<size_t>(n);
+        }
+        if (::fdatasync(log_fd_) != 0) {
+            throw_or_abort(format("Failed to sync commit log ", log_path_));
+        }
+    }
+
+    /**
+     * Replays logged batches the database doesn't hold yet. A record cut short by a crash was never acknowledged, so is
+     * dropped.
+     */
+    void recover()
+    {
+        std::ifstream log(log_path_, std::ios::binary);
+        if (!log) {
+            return;
+        }
+        std::vector<uint8_t> data((std::istreambuf_iterator<char>(log)), std::istreambuf_iterator<char>());
+        size_t replayed = 0;
+        uint8_t const* it = data.data();
+        auto end = data.data() + data.size();
+        while (end - it >= 4) {
+            uint32_t length;
+            read(it, length);
+            if (static_cast<size_t>(end - it) < length) {
+                break;
+            }
+            auto record_end = it + length;
+            uint64_t number;
+            read(it, number);
+            Batch batch;
+            while (it < record_end) {
+                uint8_t is_put;
+                Key key;
+                read(it, is_put);
+                read(it, key);
+                if (is_put) {
+                    Value value;
+                    read(it, value);
+                    batch[key] = value;
+                } else {
+                    batch[key] = std::nullopt;
+                }
+            }
+            if (number > persisted_) {
+                apply(number, batch);
+                persisted_ = number;
+                ++replayed;
+            }
+        }
+        if (replayed) {
+            std::cerr << "Replayed " << replayed << " logged commits." << std::endl;
+        }
+    }
+
+    Parent& parent_;
+    std::string log_path_;
+    bool async_;
+    // Uncommitted writes.
+    Batch writes_;
+    uint64_t committed_ = 0;
+    int log_fd_ = -1;
+
+    // Guards the queue and the persisted watermark.
+    std::mutex mutex_;
+    // Guards the database store, which isn't thread safe.
+    std::mutex database_mutex_;
+    std::condition_variable queued_;
+    std::condition_variable persisted_changed_;
+    // Committed batches not yet in the database, oldest first.
+    std::deque<std::pair<uint64_t, Batch>> pending_;
+    uint64_t persisted_ = 0;
+    bool stopping_ = false;
+    std::thread writer_;
+};
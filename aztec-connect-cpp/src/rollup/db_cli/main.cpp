@@ -1,74 +1,202 @@
+#include "bulk_load.hpp"
+#include "cached_store.hpp"
+#include "command.hpp"
+#include "find_leaf_indices.hpp"
 #include "get.hpp"
+#include "get_path_at.hpp"
+#include "group_commit_store.hpp"
+#include "get_range.hpp"
+#include "nullifiers_exist.hpp"
+#include "overlay.hpp"
+#include "overlay_store.hpp"
 #include "put.hpp"
+#include "snapshot.hpp"
+#include "world_state_view.hpp"
 #include <stdlib/merkle_tree/leveldb_store.hpp>
 #include <stdlib/merkle_tree/merkle_tree.hpp>
 #include <rollup/constants.hpp>
+#include <rollup/metrics/metrics.hpp>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <thread>
 
 using namespace plonk::stdlib::merkle_tree;
+namespace metrics = rollup::metrics;
 
 char const* DB_PATH = "./world_state.db";
 
-enum Command {
-    GET,
-    PUT,
-    COMMIT,
-    ROLLBACK,
-    GETPATH,
-    BATCH_PUT,
+// Tree nodes held in memory by default, a few hundred bytes each.
+constexpr size_t NODE_CACHE_SIZE = 1 << 18;
+
+// The database, with any commits still in its write ahead log replayed.
+using DurableStore = GroupCommitStore<LevelDbStore>;
+
+std::string command_label(uint8_t command)
+{
+    return metrics::label("command", command_name(command));
+}
+
+/**
+ * Records the number of items in a batched request.
+ */
+void observe_batch_size(Command command, size_t size)
+{
+    metrics::registry().observe(
+        "db_cli_batch_size", command_label(command), static_cast<double>(size), metrics::size_buckets());
+}
+
+/**
+ * Read commands are served from any view of the trees: the database, an overlay, or a snapshot.
+ */
+template <typename View> void get(View& view, std::istream& is, std::ostream& os)
+{
+    GetRequest get_request;
+    read(is, get_request);
+    // std::cerr << get_request << std::endl;
+    write(os, view.get_leaf(get_request.tree_id, get_request.index));
+}
+
+template <typename View> void get_range(View& view, std::istream& is, std::ostream& os)
+{
+    GetRangeRequest get_range_request;
+    read(is, get_range_request);
+    // std::cerr << get_range_request << std::endl;
+    // Leaves past the tree's size are empty, so aren't returned. The count comes off the wire, so values are streamed
+    // rather than buffered. Each leaf is a point lookup of its leaf key. The keys are adjacent, so mostly hit the same
+    // blocks, but this isn't a scan.
+    auto tree_size = view.size(get_range_request.tree_id);
+    auto start = get_range_request.start;
+    auto available = start < tree_size ? tree_size - start : uint256_t(0);
+    auto count = static_cast<uint32_t>(std::min(uint256_t(get_range_request.count), available));
+    observe_batch_size(GET_RANGE, count);
+    write(os, count);
+    for (uint32_t i = 0; i < count; ++i) {
+        write(os, view.get_leaf(get_range_request.tree_id, start + i));
+    }
+}
+
+template <typename View> void get_path(View& view, std::istream& is, std::ostream& os)
+{
+    GetRequest get_request;
+    read(is, get_request);
+    // std::cerr << get_request << std::endl;
+    write(os, view.get_hash_path(get_request.tree_id, get_request.index));
+}
+
+struct WorldStateDbOptions {
+    // The number of past versions to serve hash paths for, or 0 for all of them. Their nodes' storage isn't reclaimed.
+    uint32_t served_versions = 0;
+    size_t node_cache_size = NODE_CACHE_SIZE;
+    // Acknowledge commits once logged, and write them to the database in the background.
+    bool async_commit = false;
+    // Path of a Prometheus text file to export metrics to, blank for none.
+    std::string metrics_path;
 };
 
 class WorldStateDb {
   public:
-    WorldStateDb(std::string const& db_path)
+    WorldStateDb(std::string const& db_path, WorldStateDbOptions const& options = {})
         : store_(db_path)
-        , data_tree_(store_, rollup::DATA_TREE_DEPTH, 0)
-        , nullifier_tree_(store_, rollup::NULL_TREE_DEPTH, 1)
-        , root_tree_(store_, rollup::ROOT_TREE_DEPTH, 2)
-        , defi_tree_(store_, rollup::DEFI_TREE_DEPTH, 3)
-        , trees_({ &data_tree_, &nullifier_tree_, &root_tree_, &defi_tree_ })
+        , durable_(store_, db_path + ".log", options.async_commit)
+        , cache_(durable_, options.node_cache_size)
+        , base_(cache_)
+        , served_versions_(options.served_versions)
+        // Exported at most every 15s, the default Prometheus scrape interval.
+        , exporter_(options.metrics_path, std::chrono::seconds(15))
     {
-        if (root_tree_.size() == 0) {
-            root_tree_.update_element(0, data_tree_.root());
-            store_.commit();
+        if (base_.size(2) == 0) {
+            base_.update_element(2, 0, base_.root(0));
         }
+        // Databases created before versions were recorded get their current version on first open.
+        if (!base_.has_version()) {
+            base_.write_version(served_versions_);
+            cache_.commit();
+        }
+        versioned_size_ = base_.size(2);
+        load_value_index();
+        load_nullifier_index();
 
-        std::cerr << "Data root: " << data_tree_.root() << " size: " << data_tree_.size() << std::endl;
-        std::cerr << "Null root: " << nullifier_tree_.root() << " size: " << nullifier_tree_.size() << std::endl;
-        std::cerr << "Root root: " << root_tree_.root() << " size: " << root_tree_.size() << std::endl;
-        std::cerr << "Defi root: " << defi_tree_.root() << " size: " << defi_tree_.size() << std::endl;
+        std::cerr << "Data root: " << base_.root(0) << " size: " << base_.size(0) << std::endl;
+        std::cerr << "Null root: " << base_.root(1) << " size: " << base_.size(1) << std::endl;
+        std::cerr << "Root root: " << base_.root(2) << " size: " << base_.size(2) << std::endl;
+        std::cerr << "Defi root: " << base_.root(3) << " size: " << base_.size(3) << std::endl;
     }
 
     void write_metadata(std::ostream& os)
     {
-        write(os, data_tree_.root());
-        write(os, nullifier_tree_.root());
-        write(os, root_tree_.root());
-        write(os, defi_tree_.root());
-        write(os, data_tree_.size());
-        write(os, nullifier_tree_.size());
-        write(os, root_tree_.size());
-        write(os, defi_tree_.size());
+        with_selected([&](auto& view) { view.write_metadata(os); });
     }
 
     void get(std::istream& is, std::ostream& os)
     {
-        GetRequest get_request;
-        read(is, get_request);
-        // std::cerr << get_request << std::endl;
-        auto tree = trees_[get_request.tree_id];
-        auto path = tree->get_hash_path(get_request.index);
-        auto leaf = get_request.index & 0x1 ? path[0].second : path[0].first;
-        write(os, leaf);
+        with_selected([&](auto& view) { ::get(view, is, os); });
+    }
+
+    void get_range(std::istream& is, std::ostream& os)
+    {
+        with_selected([&](auto& view) { ::get_range(view, is, os); });
     }
 
     void get_path(std::istream& is, std::ostream& os)
     {
-        GetRequest get_request;
-        read(is, get_request);
-        // std::cerr << get_request << std::endl;
-        auto tree = trees_[get_request.tree_id];
-        auto path = tree->get_hash_path(get_request.index);
-        write(os, path);
+        with_selected([&](auto& view) { ::get_path(view, is, os); });
+    }
+
+    /**
+     * Serves a hash path below a tree's root as of a committed version, without replaying state.
+     */
+    void get_path_at(std::istream& is, std::ostream& os)
+    {
+        GetPathAtRequest get_path_at_request;
+        read(is, get_path_at_request);
+        // std::cerr << get_path_at_request << std::endl;
+        GetPathAtResponse get_path_at_response;
+        with_selected([&](auto& view) {
+            get_path_at_response.path = view.get_hash_path_at(
+                get_path_at_request.tree_id, get_path_at_request.version, get_path_at_request.index);
+        });
+        write(os, get_path_at_response);
+    }
+
+    /**
+     * Answers whether each of a batch of nullifiers is in the selected view's nullifier tree, from the leaf index.
+     */
+    void nullifiers_exist(std::istream& is, std::ostream& os)
+    {
+        NullifiersExistRequest nullifiers_exist_request;
+        read(is, nullifiers_exist_request);
+        // std::cerr << nullifiers_exist_request << std::endl;
+        NullifiersExistResponse nullifiers_exist_response;
+        nullifiers_exist_response.exists.reserve(nullifiers_exist_request.nullifiers.size());
+        observe_batch_size(NULLIFIERS_EXIST, nullifiers_exist_request.nullifiers.size());
+        with_selected([&](auto& view) {
+            for (auto const& nullifier : nullifiers_exist_request.nullifiers) {
+                nullifiers_exist_response.exists.push_back(view.nullifier_exists(nullifier));
+            }
+        });
+        write(os, nullifiers_exist_response);
+    }
+
+    /**
+     * Finds the indices of a batch of commitments in the data tree, or of data roots in the root tree.
+     */
+    void find_leaf_indices(std::istream& is, std::ostream& os)
+    {
+        FindLeafIndicesRequest find_leaf_indices_request;
+        read(is, find_leaf_indices_request);
+        // std::cerr << find_leaf_indices_request << std::endl;
+        observe_batch_size(FIND_LEAF_INDICES, find_leaf_indices_request.values.size());
+        FindLeafIndicesResponse find_leaf_indices_response;
+        with_selected([&](auto& view) {
+            for (auto const& value : find_leaf_indices_request.values) {
+                find_leaf_indices_response.indices.push_back(
+                    view.find_leaf_index(find_leaf_indices_request.tree_id, value));
+            }
+        });
+        write(os, find_leaf_indices_response);
     }
 
     void put(std::istream& is, std::ostream& os)
@@ -77,7 +205,9 @@ class WorldStateDb {
         read(is, put_request);
         // std::cerr << put_request << std::endl;
         PutResponse put_response;
-        put_response.root = trees_[put_request.tree_id]->update_element(put_request.index, put_request.value);
+        with_selected([&](auto& view) {
+            put_response.root = view.update_element(put_request.tree_id, put_request.index, put_request.value);
+        });
         write(os, put_response);
     }
 
@@ -85,80 +215,522 @@ class WorldStateDb {
     {
         std::vector<PutRequest> put_requests;
         read(is, put_requests);
-        for (auto& put_request : put_requests) {
-            trees_[put_request.tree_id]->update_element(put_request.index, put_request.value);
-        }
+        observe_batch_size(BATCH_PUT, put_requests.size());
+        with_selected([&](auto& view) {
+            // Runs of consecutive leaves in a tree are written together, so appends are hashed as one batch.
+            for (size_t i = 0; i < put_requests.size();) {
+                auto const& first = put_requests[i];
+                std::vector<barretenberg::fr> values = { first.value };
+                for (++i; i < put_requests.size() && put_requests[i].tree_id == first.tree_id &&
+                          put_requests[i].index == first.index + values.size();
+                     ++i) {
+                    values.push_back(put_requests[i].value);
+                }
+                view.update_elements(first.tree_id, first.index, values);
+            }
+        });
         write_metadata(os);
     }
 
+    /**
+     * Responds with the number of the last commit and of the last commit written to the database, once they're equal
+     * if asked to wait.
+     */
+    void persisted(std::istream& is, std::ostream& os)
+    {
+        uint8_t wait;
+        read(is, wait);
+        auto [last_commit, last_persisted] = durable_.watermarks(wait);
+        write(os, last_commit);
+        write(os, last_persisted);
+    }
+
     void commit(std::ostream& os)
     {
         // std::cerr << "COMMIT" << std::endl;
-        store_.commit();
+        // A version is recorded per data root, so only when the root tree grows.
+        if (base_.size(2) > versioned_size_) {
+            base_.write_version(served_versions_);
+            versioned_size_ = base_.size(2);
+        }
+        cache_.commit();
         write_metadata(os);
     }
 
+    /**
+     * Responds with the metrics in Prometheus' text format, as written to the metrics file.
+     */
+    void stats(std::ostream& os)
+    {
+        update_gauges();
+        write(os, metrics::registry().to_string());
+    }
+
+    /**
+     * Exports the metrics if an export is due, or regardless if forced.
+     */
+    void export_metrics(bool force = false)
+    {
+        update_gauges();
+        if (force) {
+            exporter_.flush();
+        } else {
+            exporter_.tick();
+        }
+    }
+
     void rollback(std::ostream& os)
     {
         // std::cerr << "ROLLBACK" << std::endl;
-        store_.rollback();
+        cache_.rollback();
+        base_.reload();
         write_metadata(os);
     }
 
+    /**
+     * Creates an overlay on the database or another overlay, and selects it. Subsequent reads and writes go to the
+     * selected overlay, until another is selected.
+     */
+    void fork(std::istream& is, std::ostream& os)
+    {
+        ForkRequest fork_request;
+        read(is, fork_request);
+        // std::cerr << fork_request << std::endl;
+        if (fork_request.name.empty() || overlays_.count(fork_request.name) ||
+            (!fork_request.parent.empty() && !overlays_.count(fork_request.parent))) {
+            respond(os, false, FORK);
+            return;
+        }
+
+        auto& overlay = overlays_[fork_request.name];
+        overlay.parent = fork_request.parent;
+        overlay.fork_roots = roots(overlay.parent);
+        if (overlay.parent.empty()) {
+            overlay.store = std::make_unique<OverlayStore>(cache_);
+        } else {
+            auto& parent = overlays_[overlay.parent];
+            overlay.store = std::make_unique<OverlayStore>(*parent.store);
+        }
+        overlay.view = std::make_unique<WorldStateView<OverlayStore>>(*overlay.store);
+        selected_ = fork_request.name;
+        respond(os, true, FORK);
+    }
+
+    /**
+     * Selects an overlay, or the database if the name is empty.
+     */
+    void select(std::istream& is, std::ostream& os)
+    {
+        OverlayRequest request;
+        read(is, request);
+        if (!request.name.empty() && !overlays_.count(request.name)) {
+            respond(os, false, SELECT);
+            return;
+        }
+        selected_ = request.name;
+        respond(os, true, SELECT);
+    }
+
+    /**
+     * Applies an overlay's writes to its parent, removes it, and selects the parent.
+     * Merging into the database adds the writes to its pending changes, which still need a COMMIT to persist.
+     * The overlay's writes are replayed as they are, so the merge is refused if the parent's trees have changed since
+     * the fork (by a sibling's merge, a write, or a rollback). The overlay is kept, and can still be dropped.
+     */
+    void merge(std::istream& is, std::ostream& os)
+    {
+        OverlayRequest request;
+        read(is, request);
+        if (!can_remove(request.name) || roots(overlays_[request.name].parent) != overlays_[request.name].fork_roots) {
+            respond(os, false, MERGE);
+            return;
+        }
+        auto parent = overlays_[request.name].parent;
+        overlays_[request.name].store->commit();
+        remove(request.name);
+        if (parent.empty()) {
+            base_.reload();
+        } else {
+            overlays_[parent].view->reload();
+        }
+        respond(os, true, MERGE);
+    }
+
+    /**
+     * Discards an overlay and selects its parent.
+     */
+    void drop(std::istream& is, std::ostream& os)
+    {
+        OverlayRequest request;
+        read(is, request);
+        if (!can_remove(request.name)) {
+            respond(os, false, DROP);
+            return;
+        }
+        remove(request.name);
+        respond(os, true, DROP);
+    }
+
   private:
+    struct Overlay {
+        std::string parent;
+        std::unique_ptr<OverlayStore> store;
+        std::unique_ptr<WorldStateView<OverlayStore>> view;
+        // The parent's roots when the overlay was forked.
+        std::vector<barretenberg::fr> fork_roots;
+    };
+
+    /**
+     * Databases created before the value index have their existing data and root tree leaves added on first open.
+     */
+    void load_value_index()
+    {
+        for (uint8_t tree_id : { 0, 2 }) {
+            std::vector<uint8_t> marker;
+            if (durable_.get(value_index_marker_key(tree_id), marker)) {
+                continue;
+            }
+            auto start = std::chrono::steady_clock::now();
+            auto levels = tree_levels::LevelReader<DurableStore>(durable_, tree_levels::TREE_DEPTHS[tree_id])
+                              .read(base_.root(tree_id));
+            auto tree = levels.view();
+            for (size_t pos = 0; pos < tree.level(0).count; ++pos) {
+                durable_.put(value_index_key(tree_id, tree.hash_at(0, pos)), to_buffer(tree.index_at(0, pos)));
+                if ((pos + 1) % tree_levels::BATCH_SIZE == 0) {
+                    durable_.commit();
+                }
+            }
+            durable_.put(value_index_marker_key(tree_id), { 1 });
+            durable_.commit();
+            std::cerr << "Indexed " << tree.level(0).count << " leaves of tree " << (int)tree_id << " in "
+                      << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start)
+                             .count()
+                      << "ms" << std::endl;
+        }
+    }
+
+    /**
+     * Databases created before the leaf index have nullifiers with no indexed leaf, so theirs are added on first open.
+     * The nullifier tree is only walked this once.
+     */
+    void load_nullifier_index()
+    {
+        std::vector<uint8_t> marker;
+        if (durable_.get(nullifier_index_marker_key(), marker)) {
+            return;
+        }
+        auto start = std::chrono::steady_clock::now();
+        auto levels = tree_levels::LevelReader<DurableStore>(durable_, rollup::NULL_TREE_DEPTH).read(base_.root(1));
+        auto tree = levels.view();
+        for (size_t pos = 0; pos < tree.level(0).count; ++pos) {
+            durable_.put(leaf_key(NULL_TREE, tree.index_at(0, pos)), to_buffer(tree.hash_at(0, pos)));
+            if ((pos + 1) % tree_levels::BATCH_SIZE == 0) {
+                durable_.commit();
+            }
+        }
+        durable_.put(nullifier_index_marker_key(), { 1 });
+        durable_.commit();
+        std::cerr << "Indexed " << tree.level(0).count << " nullifiers in "
+                  << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start)
+                         .count()
+                  << "ms" << std::endl;
+    }
+
+    template <typename F> void with_selected(F const& f) { with_view(selected_, f); }
+
+    /**
+     * Calls f with an overlay's view, or the database's if the name is empty.
+     */
+    template <typename F> void with_view(std::string const& name, F const& f)
+    {
+        if (name.empty()) {
+            f(base_);
+        } else {
+            f(*overlays_[name].view);
+        }
+    }
+
+    std::vector<barretenberg::fr> roots(std::string const& name)
+    {
+        std::vector<barretenberg::fr> roots;
+        with_view(name, [&](auto& view) {
+            for (uint8_t tree_id = 0; tree_id < 4; ++tree_id) {
+                roots.push_back(view.root(tree_id));
+            }
+        });
+        return roots;
+    }
+
+    /**
+     * Overlays are layered on their parent's store, so can only be removed once they have no children.
+     */
+    bool can_remove(std::string const& name)
+    {
+        if (!overlays_.count(name)) {
+            return false;
+        }
+        for (auto const& entry : overlays_) {
+            if (entry.second.parent == name) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void remove(std::string const& name)
+    {
+        selected_ = overlays_[name].parent;
+        overlays_.erase(name);
+    }
+
+    /**
+     * Overlay commands respond with a success byte, followed by the metadata of the selected view on success.
+     */
+    void respond(std::ostream& os, bool success, Command command)
+    {
+        if (!success) {
+            metrics::registry().increment("db_cli_command_failures_total", command_label(command));
+        }
+        write(os, static_cast<uint8_t>(success));
+        if (success) {
+            write_metadata(os);
+        }
+    }
+
+    void update_gauges()
+    {
+        auto& registry = metrics::registry();
+        auto const& stats = cache_.stats();
+        registry.set("db_cli_node_cache_reads", "result=\"hit\"", static_cast<double>(stats.hits));
+        registry.set("db_cli_node_cache_reads", "result=\"empty\"", static_cast<double>(stats.empty_hits));
+        registry.set("db_cli_node_cache_reads", "result=\"miss\"", static_cast<double>(stats.misses));
+        registry.set("db_cli_node_cache_nodes", "", static_cast<double>(cache_.size()));
+        registry.set("db_cli_overlays", "", static_cast<double>(overlays_.size()));
+    }
+
+
     LevelDbStore store_;
-    LevelDbTree data_tree_;
-    LevelDbTree nullifier_tree_;
-    LevelDbTree root_tree_;
-    LevelDbTree defi_tree_;
-    std::array<LevelDbTree*, 4> trees_;
+    DurableStore durable_;
+    CachedStore<DurableStore> cache_;
+    WorldStateView<CachedStore<DurableStore>> base_;
+    uint32_t served_versions_;
+    // The root tree size when the last version was recorded.
+    uint256_t versioned_size_;
+    std::map<std::string, Overlay> overlays_;
+    std::string selected_;
+    metrics::PeriodicExporter exporter_;
 };
 
+bool read_command(uint8_t& command)
+{
+    if (!std::cin.good() || std::cin.peek() == std::char_traits<char>::eof()) {
+        return false;
+    }
+    read(std::cin, command);
+    return true;
+}
+
+void dispatch(WorldStateDb& world_state_db, uint8_t command)
+{
+    switch (command) {
+    case GET:
+        world_state_db.get(std::cin, std::cout);
+        break;
+    case GET_RANGE:
+        world_state_db.get_range(std::cin, std::cout);
+        break;
+    case GETPATH:
+        world_state_db.get_path(std::cin, std::cout);
+        break;
+    case PUT:
+        world_state_db.put(std::cin, std::cout);
+        break;
+    case BATCH_PUT:
+        world_state_db.batch_put(std::cin, std::cout);
+        break;
+    case COMMIT:
+        world_state_db.commit(std::cout);
+        break;
+    case ROLLBACK:
+        world_state_db.rollback(std::cout);
+        break;
+    case FORK:
+        world_state_db.fork(std::cin, std::cout);
+        break;
+    case SELECT:
+        world_state_db.select(std::cin, std::cout);
+        break;
+    case MERGE:
+        world_state_db.merge(std::cin, std::cout);
+        break;
+    case DROP:
+        world_state_db.drop(std::cin, std::cout);
+        break;
+    case NULLIFIERS_EXIST:
+        world_state_db.nullifiers_exist(std::cin, std::cout);
+        break;
+    case FIND_LEAF_INDICES:
+        world_state_db.find_leaf_indices(std::cin, std::cout);
+        break;
+    case GETPATH_AT:
+        world_state_db.get_path_at(std::cin, std::cout);
+        break;
+    case PERSISTED:
+        world_state_db.persisted(std::cin, std::cout);
+        break;
+    case STATS:
+        world_state_db.stats(std::cout);
+        break;
+    default:
+        std::cerr << "Unknown command: " << static_cast<int>(command) << std::endl;
+        metrics::registry().increment("db_cli_unknown_commands_total");
+        break;
+    }
+}
+
+// Read commands from stdin.
+void serve(WorldStateDb& world_state_db)
+{
+    uint8_t command;
+    while (read_command(command)) {
+        {
+            metrics::ScopedTimer timer("db_cli_command_seconds", command_label(command));
+            dispatch(world_state_db, command);
+        }
+        world_state_db.export_metrics();
+    }
+    world_state_db.export_metrics(true);
+}
+
+/**
+ * Serves reads from a mapped snapshot straight away, while it's imported into an empty database in the background.
+ * The first command the snapshot can't serve waits for the import to finish, then the database takes over.
+ */
+int serve_snapshot(std::string const& snapshot_path, std::string const& db_path, WorldStateDbOptions const& options)
+{
+    snapshot::Snapshot snapshot(snapshot_path);
+    std::atomic<bool> imported = false;
+    std::thread importer([&]() {
+        LevelDbStore store(db_path);
+        DurableStore durable(store, db_path + ".log", false);
+        auto start = std::chrono::steady_clock::now();
+        snapshot.import(durable);
+        std::cerr << "Imported snapshot in "
+                  << std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now() - start).count()
+                  << "s" << std::endl;
+        imported = true;
+    });
+
+    snapshot.write_metadata(std::cout);
+
+    uint8_t command;
+    bool pending = false;
+    while (read_command(command)) {
+        if (!imported) {
+            switch (command) {
+            case GET:
+                get(snapshot, std::cin, std::cout);
+                continue;
+            case GET_RANGE:
+                get_range(snapshot, std::cin, std::cout);
+                continue;
+            case GETPATH:
+                get_path(snapshot, std::cin, std::cout);
+                continue;
+            }
+        }
+        pending = true;
+        break;
+    }
+    importer.join();
+
+    if (!pending) {
+        return 0;
+    }
+    WorldStateDb world_state_db(db_path, options);
+    dispatch(world_state_db, command);
+    serve(world_state_db);
+    return 0;
+}
+
+/**
+ * Parses the database options, given positionally from args[first]: served versions, node cache size, async commit
+ * ("true") and metrics path.
+ */
+WorldStateDbOptions parse_options(std::vector<std::string> const& args, size_t first)
+{
+    WorldStateDbOptions options;
+    if (args.size() > first) {
+        options.served_versions = static_cast<uint32_t>(std::stoul(args[first]));
+    }
+    if (args.size() > first + 1) {
+        options.node_cache_size = std::stoul(args[first + 1]);
+    }
+    options.async_commit = args.size() > first + 2 && args[first + 2] == "true";
+    options.metrics_path = args.size() > first + 3 ? args[first + 3] : "";
+    return options;
+}
+
 int main(int argc, char** argv)
 {
     std::vector<std::string> args(argv, argv + argc);
 
     if (args.size() > 1 && args[1] == "reset") {
-        LevelDbStore::destroy(args.size() > 2 ? args[2] : DB_PATH);
+        std::string db_path = args.size() > 2 ? args[2] : DB_PATH;
+        LevelDbStore::destroy(db_path);
+        std::remove((db_path + ".log").c_str());
         std::cout << "Erased db." << std::endl;
         return 0;
     }
 
-    WorldStateDb world_state_db(args.size() > 1 ? args[1] : DB_PATH);
+    // The offline commands below go through the write ahead log like the server does, so they see (and, for an
+    // emptiness check, count) any commits an asynchronous server logged but didn't write to the database.
 
-    world_state_db.write_metadata(std::cout);
-
-    // Read commands from stdin.
-    while (true) {
-        uint8_t command;
-
-        if (!std::cin.good() || std::cin.peek() == std::char_traits<char>::eof()) {
-            break;
-        }
-
-        read(std::cin, command);
-
-        switch (command) {
-        case GET:
-            world_state_db.get(std::cin, std::cout);
-            break;
-        case GETPATH:
-            world_state_db.get_path(std::cin, std::cout);
-            break;
-        case PUT:
-            world_state_db.put(std::cin, std::cout);
-            break;
-        case BATCH_PUT:
-            world_state_db.batch_put(std::cin, std::cout);
-            break;
-        case COMMIT:
-            world_state_db.commit(std::cout);
-            break;
-        case ROLLBACK:
-            world_state_db.rollback(std::cout);
-            break;
+    // Builds the trees of an empty database from a stream of leaves, read from a file or stdin.
+    if (args.size() > 1 && args[1] == "bulk-load") {
+        std::string db_path = args.size() > 2 ? args[2] : DB_PATH;
+        LevelDbStore store(db_path);
+        DurableStore durable(store, db_path + ".log", false);
+        if (args.size() > 3) {
+            std::ifstream leaves(args[3], std::ios::binary);
+            bulk_load::load(durable, leaves);
+        } else {
+            bulk_load::load(durable, std::cin);
         }
+        std::cout << "Bulk load complete." << std::endl;
+        return 0;
     }
 
+    if (args.size() > 2 && args[1] == "snapshot-export") {
+        std::string db_path = args.size() > 3 ? args[3] : DB_PATH;
+        LevelDbStore store(db_path);
+        DurableStore durable(store, db_path + ".log", false);
+        std::ofstream file(args[2], std::ios::binary);
+        snapshot::export_snapshot(durable, file);
+        std::cout << "Exported snapshot." << std::endl;
+        return 0;
+    }
+
+    if (args.size() > 2 && args[1] == "snapshot-import") {
+        snapshot::Snapshot snapshot(args[2]);
+        std::string db_path = args.size() > 3 ? args[3] : DB_PATH;
+        LevelDbStore store(db_path);
+        DurableStore durable(store, db_path + ".log", false);
+        snapshot.import(durable);
+        std::cout << "Imported snapshot." << std::endl;
+        return 0;
+    }
+
+    // Takes the same options as serving the database, after the snapshot and database paths.
+    if (args.size() > 2 && args[1] == "snapshot-serve") {
+        return serve_snapshot(args[2], args.size() > 3 ? args[3] : DB_PATH, parse_options(args, 4));
+    }
+
+    WorldStateDb world_state_db(args.size() > 1 ? args[1] : DB_PATH, parse_options(args, 2));
+
+    world_state_db.write_metadata(std::cout);
+
+    serve(world_state_db);
+
     return 0;
 }
@@ -0,0 +1,26 @@
+#pragma once
+#include <common/serialize.hpp>
+
+struct NullifiersExistRequest {
+    std::vector<uint256_t> nullifiers;
+};
+
+struct NullifiersExistResponse {
+    // One byte per requested nullifier, 1 if it's in the nullifier tree.
+    std::vector<uint8_t> exists;
+};
+
+void read(std::istream& s, NullifiersExistRequest& r)
+{
+    read(s, r.nullifiers);
+}
+
+void write(std::ostream& s, NullifiersExistResponse const& r)
+{
+    write(s, r.exists);
+}
+
+std::ostream& operator<<(std::ostream& os, NullifiersExistRequest const& nullifiers_exist_request)
+{
+    return os << "NULLIFIERS_EXIST (count:" << nullifiers_exist_request.nullifiers.size() << ")";
+}
@@ -0,0 +1,28 @@
+#pragma once
+#include <common/serialize.hpp>
+
+struct ForkRequest {
+    std::string name;
+    // The overlay to fork from, or empty to fork from the database.
+    std::string parent;
+};
+
+struct OverlayRequest {
+    std::string name;
+};
+
+void read(std::istream& s, ForkRequest& r)
+{
+    read(s, r.name);
+    read(s, r.parent);
+}
+
+void read(std::istream& s, OverlayRequest& r)
+{
+    read(s, r.name);
+}
+
+std::ostream& operator<<(std::ostream& os, ForkRequest const& fork_request)
+{
+    return os << "FORK (name:" << fork_request.name << " parent:" << fork_request.parent << ")";
+}
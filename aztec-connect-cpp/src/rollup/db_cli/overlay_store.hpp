@@ -0,0 +1,86 @@
+#pragma once
+#include <functional>
+#include <map>
+#include <optional>
+#include <vector>
+
+/**
+ * An in memory, copy-on-write layer over another store (the database, or another overlay).
+ * Writes are held in the overlay until `commit`, which applies them to the parent store. Reads see the overlay's own
+ * writes, falling through to the parent.
+ *
+ * Tree nodes are keyed by their 32 byte hash, so their values never change. Node reads from the parent are cached in
+ * the overlay, so building a block in an overlay only reads each node from disk once. Other keys (tree metadata, leaf
+ * index) are mutable, so are always read through.
+ */
+class OverlayStore {
+  public:
+    using Key = std::vector<uint8_t>;
+    using Value = std::vector<uint8_t>;
+
+    template <typename Parent>
+    explicit OverlayStore(Parent& parent)
+        : parent_get_([&parent](Key const& key, Value& value) { return parent.get(key, value); })
+        , parent_put_([&parent](Key const& key, Value const& value) { parent.put(key, value); })
+        , parent_del_([&parent](Key const& key) { parent.del(key); })
+    {}
+
+    OverlayStore(OverlayStore const&) = delete;
+    OverlayStore& operator=(OverlayStore const&) = delete;
+
+    bool get(Key const& key, Value& value)
+    {
+        auto it = writes_.find(key);
+        if (it != writes_.end()) {
+            if (!it->second) {
+                return false;
+            }
+            value = *it->second;
+            return true;
+        }
+
+        auto cached = node_cache_.find(key);
+        if (cached != node_cache_.end()) {
+            value = cached->second;
+            return true;
+        }
+
+        if (!parent_get_(key, value)) {
+            return false;
+        }
+        if (key.size() == 32) {
+            node_cache_[key] = value;
+        }
+        return true;
+    }
+
+    void put(Key const& key, Value const& value) { writes_[key] = value; }
+
+    void del(Key const& key) { writes_[key] = std::nullopt; }
+
+    /**
+     * Applies this overlay's writes to its parent.
+     */
+    void commit()
+    {
+        for (auto const& [key, value] : writes_) {
+            if (value) {
+                parent_put_(key, *value);
+            } else {
+                parent_del_(key);
+            }
+        }
+        writes_.clear();
+    }
+
+    void rollback() { writes_.clear(); }
+
+    size_t num_writes() const { return writes_.size(); }
+
+  private:
+    std::function<bool(Key const&, Value&)> parent_get_;
+    std::function<void(Key const&, Value const&)> parent_put_;
+    std::function<void(Key const&)> parent_del_;
+    std::map<Key, std::optional<Value>> writes_;
+    std::map<Key, Value> node_cache_;
+};
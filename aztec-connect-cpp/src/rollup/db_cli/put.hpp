@@ -20,6 +20,13 @@ void read(std::istream& s, PutRequest& r)
     read(s, r.value);
 }
 
+void write(std::ostream& s, PutRequest const& r)
+{
+    write(s, r.tree_id);
+    write(s, r.index);
+    write(s, r.value);
+}
+
 void write(std::ostream& s, PutResponse const& r)
 {
     write(s, r.root);
@@ -0,0 +1,187 @@
+#pragma once
+#include "bulk_load.hpp"
+#include "tree_levels.hpp"
+#include "world_state_view.hpp"
+#include <common/throw_or_abort.hpp>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <fstream>
+
+/**
+ * A world state snapshot is a single flat file:
+ *
+ *   magic (8 bytes)
+ *   metadata: the four tree roots then the four tree sizes, as written by WorldStateView::write_metadata
+ *   for each tree: depth (uint32), then the entry count of each level from the leaves up (uint64)
+ *   for each tree, for each level from the leaves up: the level's 64 byte entries (see tree_levels.hpp)
+ *
+ * All integers are big endian. Levels are sorted, so a mapped snapshot serves leaves and hash paths by binary search
+ * without loading anything, while it's imported into a database.
+ */
+namespace snapshot {
+
+using namespace barretenberg;
+using namespace tree_levels;
+
+constexpr char MAGIC[8] = { 'A', 'Z', 'T', 'E', 'C', 'W', 'S', '1' };
+
+template <typename Store> void export_snapshot(Store& store, std::ostream& os)
+{
+    WorldStateView<Store> view(store);
+    std::array<Levels, 4> trees;
+    for (uint8_t tree_id = 0; tree_id < TREE_DEPTHS.size(); ++tree_id) {
+        trees[tree_id] = LevelReader<Store>(store, TREE_DEPTHS[tree_id]).read(view.root(tree_id));
+    }
+    store.rollback();
+
+    os.write(MAGIC, sizeof(MAGIC));
+    view.write_metadata(os);
+    for (uint8_t tree_id = 0; tree_id < TREE_DEPTHS.size(); ++tree_id) {
+        write(os, static_cast<uint32_t>(TREE_DEPTHS[tree_id]));
+        for (auto const& level : trees[tree_id].levels) {
+            write(os, static_cast<uint64_t>(level.size() / ENTRY_SIZE));
+        }
+    }
+    for (auto const& tree : trees) {
+        for (auto const& level : tree.levels) {
+            os.write(reinterpret_cast<char const*>(level.data()), static_cast<std::streamsize>(level.size()));
+        }
+    }
+    if (!os.good()) {
+        throw_or_abort("Failed to write snapshot.");
+    }
+}
+
+/**
+ * A read only, memory mapped snapshot.
+ */
+class Snapshot {
+  public:
+    explicit Snapshot(std::string const& path)
+    {
+        fd_ = open(path.c_str(), O_RDONLY);
+        if (fd_ < 0) {
+            throw_or_abort(format("Failed to open snapshot ", path));
+        }
+        struct stat st;
+        fstat(fd_, &st);
+        size_ = static_cast<size_t>(st.st_size);
+        auto data = mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd_, 0);
+        if (data == MAP_FAILED) {
+            throw_or_abort(format("Failed to map snapshot ", path));
+        }
+        data_ = static_cast<uint8_t const*>(data);
+        parse();
+    }
+
+    Snapshot(Snapshot const&) = delete;
+    Snapshot& operator=(Snapshot const&) = delete;
+
+    ~Snapshot()
+    {
+        munmap(const_cast<uint8_t*>(data_), size_);
+        close(fd_);
+    }
+
+    fr get_leaf(uint8_t tree_id, uint256_t const& index) const { return trees_[tree_id].get_leaf(index); }
+
+    fr_hash_path get_hash_path(uint8_t tree_id, uint256_t const& index) const
+    {
+        return trees_[tree_id].get_hash_path(index);
+    }
+
+    void write_metadata(std::ostream& os) const
+    {
+        for (auto const& root : roots_) {
+            write(os, root);
+        }
+        for (auto const& size : sizes_) {
+            write(os, size);
+        }
+    }
+
+    /**
+     * Writes the snapshot's trees into an empty database.
+     */
+    template <typename Store> void import(Store& store) const
+    {
+        bulk_load::check_empty(store);
+        for (uint8_t tree_id = 0; tree_id < trees_.size(); ++tree_id) {
+            trees_[tree_id].write_to(store, tree_id, sizes_[tree_id]);
+        }
+
+        WorldStateView<Store> imported(store);
+        for (uint8_t tree_id = 0; tree_id < trees_.size(); ++tree_id) {
+            auto const& leaves = trees_[tree_id].level(0);
+            std::vector<node> last;
+            if (leaves.count) {
+                last.push_back({ trees_[tree_id].index_at(0, leaves.count - 1),
+                                 trees_[tree_id].hash_at(0, leaves.count - 1) });
+            }
+            bulk_load::verify_tree(imported, tree_id, roots_[tree_id], last);
+        }
+    }
+
+  private:
+    void parse()
+    {
+        uint8_t const* it = data_;
+        auto end = data_ + size_;
+        auto require = [&](size_t bytes) {
+            if (static_cast<size_t>(end - it) < bytes) {
+                throw_or_abort("Truncated snapshot.");
+            }
+        };
+
+        require(sizeof(MAGIC) + 256);
+        if (std::memcmp(it, MAGIC, sizeof(MAGIC)) != 0) {
+            throw_or_abort("Not a world state snapshot.");
+        }
+        it += sizeof(MAGIC);
+        for (auto& root : roots_) {
+            read(it, root);
+        }
+        for (auto& size : sizes_) {
+            read(it, size);
+        }
+
+        std::array<std::vector<uint64_t>, 4> counts;
+        for (uint8_t tree_id = 0; tree_id < counts.size(); ++tree_id) {
+            require(4);
+            uint32_t depth;
+            read(it, depth);
+            if (depth != TREE_DEPTHS[tree_id]) {
+                throw_or_abort(format("Snapshot tree ", (int)tree_id, " has depth ", depth));
+            }
+            require((depth + 1) * 8);
+            counts[tree_id].resize(depth + 1);
+            for (auto& count : counts[tree_id]) {
+                read(it, count);
+            }
+        }
+
+        for (uint8_t tree_id = 0; tree_id < counts.size(); ++tree_id) {
+            std::vector<level_view> levels;
+            for (auto count : counts[tree_id]) {
+                require(count * ENTRY_SIZE);
+                levels.push_back({ it, count });
+                it += count * ENTRY_SIZE;
+            }
+            trees_.emplace_back(TREE_DEPTHS[tree_id], levels);
+            if (trees_.back().root() != roots_[tree_id]) {
+                throw_or_abort(format("Snapshot tree ", (int)tree_id, " root mismatch."));
+            }
+        }
+    }
+
+    int fd_;
+    size_t size_;
+    uint8_t const* data_;
+    std::array<fr, 4> roots_;
+    std::array<uint256_t, 4> sizes_;
+    std::vector<TreeLevels> trees_;
+};
+
+} // namespace snapshot
@@ -0,0 +1,370 @@
+#pragma once
+#include "world_state_view.hpp"
+#include <common/throw_or_abort.hpp>
+#include <stdlib/merkle_tree/hash_path.hpp>
+#include <stdlib/merkle_tree/merkle_tree.hpp>
+#include <rollup/constants.hpp>
+#include <cstring>
+
+/**
+ * A tree held as its nodes, level by level from the leaves up. Each level is a sorted array of 64 byte entries, a big
+ * endian node index followed by the node hash, so a level can be searched bytewise in place, whether in memory or in a
+ * mapped file.
+ *
+ * Only the nodes MerkleTree would store are held: leaves, nodes over two or more leaves, and the topmost node of each
+ * single leaf subtree (which MerkleTree stores as a stump). Any other node is either empty, or hashed up from the
+ * single leaf below it.
+ */
+namespace tree_levels {
+
+using namespace barretenberg;
+using plonk::stdlib::merkle_tree::compress_native;
+using plonk::stdlib::merkle_tree::fr_hash_path;
+
+constexpr std::array<size_t, 4> TREE_DEPTHS = {
+    rollup::DATA_TREE_DEPTH, rollup::NULL_TREE_DEPTH, rollup::ROOT_TREE_DEPTH, rollup::DEFI_TREE_DEPTH
+};
+
+constexpr size_t ENTRY_SIZE = 64;
+
+// Number of node writes to accumulate before flushing a batch to the database.
+constexpr size_t BATCH_SIZE = 1 << 20;
+
+struct node {
+    uint256_t index;
+    fr value;
+};
+
+struct level_view {
+    uint8_t const* data;
+    size_t count;
+};
+
+inline void append_entry(std::vector<uint8_t>& level, uint256_t const& index, fr const& hash)
+{
+    write(level, index);
+    write(level, hash);
+}
+
+inline std::vector<fr> compute_zero_hashes(size_t depth)
+{
+    std::vector<fr> zero_hashes(depth + 1);
+    zero_hashes[0] = fr::zero();
+    for (size_t i = 0; i < depth; ++i) {
+        zero_hashes[i + 1] = compress_native(zero_hashes[i], zero_hashes[i]);
+    }
+    return zero_hashes;
+}
+
+/**
+ * Hashes a leaf up to the given height, with an empty sibling at every level. This is a stump's hash.
+ */
+inline fr compute_zero_path_hash(std::vector<fr> const& zero_hashes, size_t height, uint256_t const& index, fr value)
+{
+    for (size_t i = 0; i < height; ++i) {
+        value = index.get_bit(i) ? compress_native(zero_hashes[i], value) : compress_native(value, zero_hashes[i]);
+    }
+    return value;
+}
+
+/**
+ * Read only view of a tree's levels.
+ */
+class TreeLevels {
+  public:
+    TreeLevels(size_t depth, std::vector<level_view> levels)
+        : depth_(depth)
+        , levels_(std::move(levels))
+        , zero_hashes_(compute_zero_hashes(depth))
+    {
+        if (levels_.size() != depth_ + 1) {
+            throw_or_abort("Tree levels don't match depth.");
+        }
+    }
+
+    size_t depth() const { return depth_; }
+
+    level_view const& level(size_t height) const { return levels_[height]; }
+
+    uint256_t index_at(size_t height, size_t pos) const
+    {
+        return from_buffer<uint256_t>(levels_[height].data + pos * ENTRY_SIZE);
+    }
+
+    fr hash_at(size_t height, size_t pos) const
+    {
+        return from_buffer<fr>(levels_[height].data + pos * ENTRY_SIZE + 32);
+    }
+
+    fr root() const { return get_node(depth_, 0); }
+
+    fr get_leaf(uint256_t const& index) const { return get_node(0, index); }
+
+    fr get_node(size_t height, uint256_t const& index) const
+    {
+        auto pos = lower_bound(height, index);
+        if (pos < levels_[height].count && index_at(height, pos) == index) {
+            return hash_at(height, pos);
+        }
+        if (height == 0) {
+            return fr::zero();
+        }
+        auto [begin, end] = leaf_range(height, index);
+        if (begin == end) {
+            return zero_hashes_[height];
+        }
+        if (end - begin > 1) {
+            throw_or_abort(format("Missing node at height ", height, " index ", index));
+        }
+        return compute_zero_path_hash(zero_hashes_, height, index_at(0, begin), hash_at(0, begin));
+    }
+
+    fr_hash_path get_hash_path(uint256_t index) const
+    {
+        fr_hash_path path(depth_);
+        for (size_t height = 0; height < depth_; ++height) {
+            auto left = index - (index & 1);
+            path[height] = { get_node(height, left), get_node(height, left + 1) };
+            index >>= 1;
+        }
+        return path;
+    }
+
+    /**
+     * Positions of the first and one past the last leaf under a node.
+     */
+    std::pair<size_t, size_t> leaf_range(size_t height, uint256_t const& index) const
+    {
+        if (height == depth_) {
+            return { 0, levels_[0].count };
+        }
+        auto end_index = (index + 1) << height;
+        // The end index overflows for the last node of a level in a 256 deep tree.
+        return { lower_bound(0, index << height), end_index == 0 ? levels_[0].count : lower_bound(0, end_index) };
+    }
+
+    /**
+     * Writes the tree into a store in the format MerkleTree reads: nodes keyed by hash, stumps for single leaf
+     * subtrees, the leaf and value indices and the tree metadata. The store is committed every BATCH_SIZE writes.
+     */
+    template <typename Store> void write_to(Store& store, uint8_t tree_id, uint256_t const& size) const
+    {
+        size_t pending_writes = 0;
+        auto put = [&](std::vector<uint8_t> const& key, std::vector<uint8_t> const& value) {
+            store.put(key, value);
+            if (++pending_writes >= BATCH_SIZE) {
+                store.commit();
+                pending_writes = 0;
+            }
+        };
+
+        for (size_t pos = 0; pos < levels_[0].count; ++pos) {
+            put(leaf_key(tree_id, index_at(0, pos)), to_buffer(hash_at(0, pos)));
+            if (is_value_indexed(tree_id)) {
+                put(value_index_key(tree_id, hash_at(0, pos)), to_buffer(index_at(0, pos)));
+            }
+        }
+
+        for (size_t height = 1; height <= depth_; ++height) {
+            for (size_t pos = 0; pos < levels_[height].count; ++pos) {
+                auto index = index_at(height, pos);
+                auto [begin, end] = leaf_range(height, index);
+                std::vector<uint8_t> value;
+                if (end - begin == 1) {
+                    // Only the topmost node of a single leaf subtree is a stump.
+                    if (height < depth_) {
+                        auto [parent_begin, parent_end] = leaf_range(height + 1, index >> 1);
+                        if (parent_end - parent_begin == 1) {
+                            continue;
+                        }
+                    }
+                    write(value, hash_at(0, begin));
+                    write(value, index_at(0, begin));
+                    write(value, true);
+                } else {
+                    auto left = index << 1;
+                    write(value, get_node(height - 1, left));
+                    write(value, get_node(height - 1, left + 1));
+                }
+                put(to_buffer(hash_at(height, pos)), value);
+            }
+        }
+
+        std::vector<uint8_t> metadata;
+        write(metadata, root());
+        write(metadata, size);
+        store.put(std::vector<uint8_t>{ tree_id }, metadata);
+
+        // Every leaf is in the leaf index, and the value index.
+        store.put(leaf_index_start_key(tree_id), to_buffer(uint256_t(0)));
+        store.put(value_index_marker_key(tree_id), { 1 });
+        if (tree_id == NULL_TREE) {
+            store.put(nullifier_index_marker_key(), { 1 });
+        }
+        store.commit();
+    }
+
+  private:
+    size_t lower_bound(size_t height, uint256_t const& index) const
+    {
+        auto key = to_buffer(index);
+        auto const& level = levels_[height];
+        size_t lo = 0;
+        size_t hi = level.count;
+        while (lo < hi) {
+            auto mid = lo + (hi - lo) / 2;
+            if (std::memcmp(level.data + mid * ENTRY_SIZE, key.data(), 32) < 0) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        return lo;
+    }
+
+    size_t depth_;
+    std::vector<level_view> levels_;
+    std::vector<fr> zero_hashes_;
+};
+
+/**
+ * Levels held in memory.
+ */
+struct Levels {
+    std::vector<std::vector<uint8_t>> levels;
+
+    TreeLevels view() const
+    {
+        std::vector<level_view> views;
+        for (auto const& level : levels) {
+            views.push_back({ level.data(), level.size() / ENTRY_SIZE });
+        }
+        return TreeLevels(levels.size() - 1, views);
+    }
+};
+
+/**
+ * Builds a tree bottom up from its sorted, non zero leaves, hashing each level in parallel. Every non empty node is
+ * hashed once, and empty subtrees are never hashed.
+ *
+ * That saves little hashing over replaying PUTs: a leaf is alone in its subtree up to about log2(leaves) below the
+ * root, and each of those nodes is a hash, so a sparse tree like the 256 deep nullifier tree still costs about
+ * leaves * (256 - log2(leaves)) hashes. What it saves is the node reads, and the writes of the nodes below each stump.
+ */
+inline Levels build_levels(size_t depth, std::vector<node> const& leaves)
+{
+    auto zero_hashes = compute_zero_hashes(depth);
+    Levels result;
+    result.levels.resize(depth + 1);
+
+    // Number of leaves under each node of the current level, capped at 2.
+    std::vector<node> level = leaves;
+    std::vector<uint8_t> counts(level.size(), 1);
+    for (size_t height = 0; height < depth; ++height) {
+        // Pair up siblings. An absent sibling is the empty subtree at this height.
+        std::vector<std::pair<fr, fr>> children;
+        std::vector<node> parents;
+        std::vector<uint8_t> parent_counts;
+        for (size_t i = 0; i < level.size(); ++i) {
+            auto const& current = level[i];
+            bool has_sibling = !(current.index & 1) && i + 1 < level.size() && level[i + 1].index == current.index + 1;
+            uint8_t count = has_sibling ? 2 : counts[i];
+            for (size_t j = i; j <= i + has_sibling; ++j) {
+                if (height == 0 || counts[j] > 1 || count > 1) {
+                    append_entry(result.levels[height], level[j].index, level[j].value);
+                }
+            }
+            if (current.index & 1) {
+                children.push_back({ zero_hashes[height], current.value });
+            } else if (has_sibling) {
+                children.push_back({ current.value, level[i + 1].value });
+                ++i;
+            } else {
+                children.push_back({ current.value, zero_hashes[height] });
+            }
+            parents.push_back({ current.index >> 1, fr::zero() });
+            parent_counts.push_back(count);
+        }
+
+#ifndef NO_MULTITHREADING
+#pragma omp parallel for
+#endif
+        for (size_t i = 0; i < parents.size(); ++i) {
+            parents[i].value = compress_native(children[i].first, children[i].second);
+        }
+
+        level = std::move(parents);
+        counts = std::move(parent_counts);
+    }
+
+    if (!level.empty()) {
+        append_entry(result.levels[depth], level[0].index, level[0].value);
+    }
+    return result;
+}
+
+/**
+ * Reads a tree's levels out of a store, walking down from the root. Levels come out sorted, as each subtree is walked
+ * left before right. The full subtrees AppendOnlyTree writes come out with all their nodes, which is harmless.
+ */
+template <typename Store> class LevelReader {
+  public:
+    LevelReader(Store& store, size_t depth)
+        : store_(store)
+        , zero_hashes_(compute_zero_hashes(depth))
+    {
+        levels_.levels.resize(depth + 1);
+    }
+
+    Levels read(fr const& root)
+    {
+        walk(levels_.levels.size() - 1, 0, root);
+        return std::move(levels_);
+    }
+
+  private:
+    void walk(size_t height, uint256_t const& index, fr const& hash)
+    {
+        if (hash == zero_hashes_[height]) {
+            return;
+        }
+        append_entry(levels_.levels[height], index, hash);
+        if (height == 0) {
+            return;
+        }
+
+        std::vector<uint8_t> data;
+        if (!store_.get(to_buffer(hash), data)) {
+            throw_or_abort(format("Missing node at height ", height, " index ", index));
+        }
+        if (data.size() == 65) {
+            // A stump holds the only leaf of its subtree. Take the leaf's position within the subtree from the stump.
+            auto mask = (uint256_t(1) << height) - 1;
+            auto leaf_index = (index << height) | (from_buffer<uint256_t>(data, 32) & mask);
+            append_entry(levels_.levels[0], leaf_index, from_buffer<fr>(data, 0));
+            return;
+        }
+        if (data.size() != 64) {
+            // A full subtree written by AppendOnlyTree, holding all its nodes from the leaves up.
+            size_t offset = 0;
+            for (size_t level = 0; level < height; ++level) {
+                auto count = 1UL << (height - level);
+                for (size_t i = 0; i < count; ++i, offset += 32) {
+                    auto value = from_buffer<fr>(data, offset);
+                    if (value != zero_hashes_[level]) {
+                        append_entry(levels_.levels[level], (index << (height - level)) + i, value);
+                    }
+                }
+            }
+            return;
+        }
+        walk(height - 1, index << 1, from_buffer<fr>(data, 0));
+        walk(height - 1, (index << 1) + 1, from_buffer<fr>(data, 32));
+    }
+
+    Store& store_;
+    std::vector<fr> zero_hashes_;
+    Levels levels_;
+};
+
+} // namespace tree_levels
@@ -0,0 +1,330 @@
+#pragma once
+#include "command.hpp"
+#include <stdlib/merkle_tree/merkle_tree.hpp>
+#include <rollup/constants.hpp>
+#include <rollup/world_state/append_only_tree.hpp>
+#include <rollup/world_state/tree_reader.hpp>
+#include <array>
+#include <memory>
+#include <optional>
+
+/**
+ * Leaf values are indexed under their tree id and big endian index, alongside the tree nodes. Tree nodes are keyed by
+ * their 32 byte hash and tree metadata by the 1 byte tree id, so these keys can't collide.
+ * Big endian indices keep a tree's leaves adjacent in key order, so the lookups of a range read hit nearby blocks.
+ */
+inline std::vector<uint8_t> leaf_key(uint8_t tree_id, uint256_t const& index)
+{
+    std::vector<uint8_t> key = { 'L', tree_id };
+    auto index_buf = to_buffer(index);
+    key.insert(key.end(), index_buf.begin(), index_buf.end());
+    return key;
+}
+
+/**
+ * Holds the tree size below which leaves were written before the leaf index existed.
+ */
+inline std::vector<uint8_t> leaf_index_start_key(uint8_t tree_id)
+{
+    return { 'L', tree_id };
+}
+
+/**
+ * The data and root trees also index each leaf's index under its value, so callers can find where a commitment or a
+ * data root sits without scanning the tree.
+ */
+inline std::vector<uint8_t> value_index_key(uint8_t tree_id, barretenberg::fr const& value)
+{
+    std::vector<uint8_t> key = { 'V', tree_id };
+    auto value_buf = to_buffer(value);
+    key.insert(key.end(), value_buf.begin(), value_buf.end());
+    return key;
+}
+
+/**
+ * Present once a tree's existing leaves have been added to the value index.
+ */
+inline std::vector<uint8_t> value_index_marker_key(uint8_t tree_id)
+{
+    return { 'V', tree_id };
+}
+
+/**
+ * Present once the nullifier tree's existing leaves have been added to the leaf index, so a nullifier is spent exactly
+ * when its leaf is indexed with a non zero value.
+ */
+inline std::vector<uint8_t> nullifier_index_marker_key()
+{
+    return { 'N' };
+}
+
+inline bool is_value_indexed(uint8_t tree_id)
+{
+    return tree_id == 0 || tree_id == 2;
+}
+
+/**
+ * The roots of all four trees as of a version, the root tree index of the latest data root when they were committed.
+ */
+inline std::vector<uint8_t> version_key(uint32_t version)
+{
+    std::vector<uint8_t> key = { 'H' };
+    write(key, version);
+    return key;
+}
+
+/**
+ * Holds the oldest version still served.
+ */
+inline std::vector<uint8_t> oldest_version_key()
+{
+    return { 'H' };
+}
+
+/**
+ * The four rollup trees over one store: the database, or an overlay on it. The data and root trees are append only.
+ */
+template <typename Store> class WorldStateView {
+  public:
+    using Tree = plonk::stdlib::merkle_tree::MerkleTree<Store>;
+    using AppendOnlyTree = rollup::world_state::AppendOnlyTree<Store>;
+
+    WorldStateView(Store& store)
+        : store_(store)
+        , data_tree_(store_, rollup::DATA_TREE_DEPTH, DATA_TREE)
+        , nullifier_tree_(store_, rollup::NULL_TREE_DEPTH, NULL_TREE)
+        , root_tree_(store_, rollup::ROOT_TREE_DEPTH, ROOT_TREE)
+        , defi_tree_(store_, rollup::DEFI_TREE_DEPTH, DEFI_TREE)
+    {
+        load_leaf_index();
+    }
+
+    /**
+     * Rereads the append only trees' state after the store changed underneath the view. MerkleTree reads its root and
+     * size from the store on every call, so needs nothing.
+     */
+    void reload()
+    {
+        data_tree_.reload();
+        root_tree_.reload();
+    }
+
+    barretenberg::fr root(uint8_t tree_id)
+    {
+        return with_tree(tree_id, [](auto& tree) { return tree.root(); });
+    }
+
+    uint256_t size(uint8_t tree_id)
+    {
+        return with_tree(tree_id, [](auto& tree) { return uint256_t(tree.size()); });
+    }
+
+    plonk::stdlib::merkle_tree::fr_hash_path get_hash_path(uint8_t tree_id, uint256_t const& index)
+    {
+        return with_tree(tree_id, [&](auto& tree) { return tree.get_hash_path(index); });
+    }
+
+    void write_metadata(std::ostream& os)
+    {
+        for (uint8_t tree_id = 0; tree_id < NUM_TREES; ++tree_id) {
+            write(os, root(tree_id));
+        }
+        for (uint8_t tree_id = 0; tree_id < NUM_TREES; ++tree_id) {
+            write(os, size(tree_id));
+        }
+    }
+
+    barretenberg::fr get_leaf(uint8_t tree_id, uint256_t const& index)
+    {
+        std::vector<uint8_t> value;
+        if (store_.get(leaf_key(tree_id, index), value)) {
+            return from_buffer<barretenberg::fr>(value);
+        }
+        if (index >= indexed_from_[tree_id]) {
+            return barretenberg::fr::zero();
+        }
+        auto path = get_hash_path(tree_id, index);
+        return index & 0x1 ? path[0].second : path[0].first;
+    }
+
+    barretenberg::fr update_element(uint8_t tree_id, uint256_t const& index, barretenberg::fr const& value)
+    {
+        store_.put(leaf_key(tree_id, index), to_buffer(value));
+        index_value(tree_id, index, value);
+        return with_tree(tree_id, [&](auto& tree) { return tree.update_element(index, value); });
+    }
+
+    /**
+     * Writes consecutive leaves. Appends to the data and root trees are hashed as one batch.
+     */
+    barretenberg::fr update_elements(uint8_t tree_id,
+                                     uint256_t const& start_index,
+                                     std::vector<barretenberg::fr> const& values)
+    {
+        for (size_t i = 0; i < values.size(); ++i) {
+            store_.put(leaf_key(tree_id, start_index + i), to_buffer(values[i]));
+            index_value(tree_id, start_index + i, values[i]);
+        }
+        switch (tree_id) {
+        case 0:
+            return data_tree_.update_elements(start_index, values);
+        case 2:
+            return root_tree_.update_elements(start_index, values);
+        default:
+            for (size_t i = 0; i < values.size(); ++i) {
+                with_tree(tree_id, [&](auto& tree) { return tree.update_element(start_index + i, values[i]); });
+            }
+            return root(tree_id);
+        }
+    }
+
+    /**
+     * Whether the roots of the current version, the index of the latest data root in the root tree, are recorded.
+     */
+    bool has_version()
+    {
+        std::vector<uint8_t> roots;
+        return store_.get(version_key(static_cast<uint32_t>(size(2)) - 1), roots);
+    }
+
+    /**
+     * Records the current roots as the current version, the index of the latest data root in the root tree. Versions
+     * older than the last `served_versions` stop being served, unless it's 0.
+     *
+     * Only a version's record of its roots is deleted. Nodes are keyed by their hash and shared between versions, so
+     * the nodes of past versions stay in the database.
+     */
+    void write_version(uint32_t served_versions)
+    {
+        auto version = static_cast<uint32_t>(size(2)) - 1;
+        std::vector<uint8_t> roots;
+        for (uint8_t tree_id = 0; tree_id < NUM_TREES; ++tree_id) {
+            write(roots, root(tree_id));
+        }
+        store_.put(version_key(version), roots);
+
+        if (served_versions == 0 || version < served_versions) {
+            return;
+        }
+        std::vector<uint8_t> data;
+        uint32_t oldest = store_.get(oldest_version_key(), data) ? from_buffer<uint32_t>(data) : 0;
+        for (; oldest + served_versions <= version; ++oldest) {
+            store_.del(version_key(oldest));
+        }
+        store_.put(oldest_version_key(), to_buffer(oldest));
+    }
+
+    /**
+     * A hash path below a tree's root as of the given version, read from the nodes still in the store. The data tree's
+     * root at every version is in the root tree, so its paths are served for versions that were never recorded, or are
+     * no longer served.
+     */
+    std::optional<plonk::stdlib::merkle_tree::fr_hash_path> get_hash_path_at(uint8_t tree_id,
+                                                                              uint32_t version,
+                                                                              uint256_t const& index)
+    {
+        if (tree_id >= NUM_TREES) {
+            return std::nullopt;
+        }
+        barretenberg::fr version_root;
+        std::vector<uint8_t> roots;
+        if (store_.get(version_key(version), roots)) {
+            version_root = from_buffer<barretenberg::fr>(roots, tree_id * 32);
+        } else if (tree_id == 0 && version < size(2)) {
+            version_root = get_leaf(2, version);
+        } else {
+            return std::nullopt;
+        }
+        return reader(tree_id).get_hash_path(version_root, index);
+    }
+
+    /**
+     * Index of the leaf holding the given value in the data or root tree. A value written at several indices is found
+     * at the last one written.
+     */
+    std::optional<uint256_t> find_leaf_index(uint8_t tree_id, barretenberg::fr const& value)
+    {
+        std::vector<uint8_t> index_buf;
+        if (!is_value_indexed(tree_id) || value == barretenberg::fr::zero() ||
+            !store_.get(value_index_key(tree_id, value), index_buf)) {
+            return std::nullopt;
+        }
+        auto index = from_buffer<uint256_t>(index_buf);
+        // The leaf may since have been overwritten.
+        if (get_leaf(tree_id, index) != value) {
+            return std::nullopt;
+        }
+        return index;
+    }
+
+    /**
+     * Whether a nullifier is in the nullifier tree, read from its leaf in one lookup rather than its 256 deep path.
+     * Only exact once the tree's leaves written before the leaf index are indexed, under `nullifier_index_marker_key`.
+     */
+    bool nullifier_exists(uint256_t const& nullifier)
+    {
+        std::vector<uint8_t> value;
+        return store_.get(leaf_key(NULL_TREE, nullifier), value) &&
+               from_buffer<barretenberg::fr>(value) != barretenberg::fr::zero();
+    }
+
+  private:
+    static constexpr uint8_t NUM_TREES = 4;
+
+    rollup::world_state::TreeReader<Store>& reader(uint8_t tree_id)
+    {
+        if (!readers_[tree_id]) {
+            readers_[tree_id] = std::make_unique<rollup::world_state::TreeReader<Store>>(
+                store_, with_tree(tree_id, [](auto& tree) { return tree.depth(); }));
+        }
+        return *readers_[tree_id];
+    }
+
+    void index_value(uint8_t tree_id, uint256_t const& index, barretenberg::fr const& value)
+    {
+        if (is_value_indexed(tree_id) && value != barretenberg::fr::zero()) {
+            store_.put(value_index_key(tree_id, value), to_buffer(index));
+        }
+    }
+
+    template <typename F> auto with_tree(uint8_t tree_id, F const& f)
+    {
+        switch (tree_id) {
+        case 0:
+            return f(data_tree_);
+        case 1:
+            return f(nullifier_tree_);
+        case 2:
+            return f(root_tree_);
+        default:
+            return f(defi_tree_);
+        }
+    }
+
+    /**
+     * Databases created before the leaf index have unindexed leaves below the tree size at which indexing started.
+     * We record that size on first open, and fall back to reading those leaves from their hash path.
+     */
+    void load_leaf_index()
+    {
+        for (uint8_t tree_id = 0; tree_id < NUM_TREES; ++tree_id) {
+            auto key = leaf_index_start_key(tree_id);
+            std::vector<uint8_t> value;
+            if (store_.get(key, value)) {
+                indexed_from_[tree_id] = from_buffer<uint256_t>(value);
+            } else {
+                indexed_from_[tree_id] = size(tree_id);
+                store_.put(key, to_buffer(indexed_from_[tree_id]));
+            }
+        }
+    }
+
+    Store& store_;
+    AppendOnlyTree data_tree_;
+    Tree nullifier_tree_;
+    AppendOnlyTree root_tree_;
+    Tree defi_tree_;
+    std::array<uint256_t, NUM_TREES> indexed_from_;
+    // Readers for paths below past roots, made on first use.
+    std::array<std::unique_ptr<rollup::world_state::TreeReader<Store>>, NUM_TREES> readers_;
+};
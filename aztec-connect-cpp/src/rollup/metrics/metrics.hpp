@@ -0,0 +1,275 @@
+#pragma once
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#ifndef NO_MULTITHREADING
+#include <mutex>
+#endif
+
+namespace rollup {
+namespace metrics {
+
+/**
+ * Bucket upper bounds for durations in seconds, from a millisecond up to the ten minutes a large proof can take.
+ */
+inline std::vector<double> const& duration_buckets()
+{
+    static const std::vector<double> buckets = { 0.001, 0.005, 0.01, 0.05, 0.1, 0.5, 1, 5, 10, 30, 60, 120, 300, 600 };
+    return buckets;
+}
+
+/**
+ * Bucket upper bounds for batch sizes, in powers of four.
+ */
+inline std::vector<double> const& size_buckets()
+{
+    static const std::vector<double> buckets = { 1, 4, 16, 64, 256, 1024, 4096, 16384, 65536 };
+    return buckets;
+}
+
+class Histogram {
+  public:
+    explicit Histogram(std::vector<double> const& bounds)
+        : bounds_(bounds)
+        , counts_(bounds.size(), 0)
+    {}
+
+    void observe(double value)
+    {
+        for (size_t i = 0; i < bounds_.size(); ++i) {
+            if (value <= bounds_[i]) {
+                ++counts_[i];
+                break;
+            }
+        }
+        sum_ += value;
+        ++count_;
+    }
+
+    uint64_t count() const { return count_; }
+
+    double sum() const { return sum_; }
+
+    void write(std::ostream& os, std::string const& name, std::string const& labels) const
+    {
+        auto separator = labels.empty() ? "" : ",";
+        uint64_t cumulative = 0;
+        for (size_t i = 0; i < bounds_.size(); ++i) {
+            cumulative += counts_[i];
+            os << name << "_bucket{" << labels << separator << "le=\"" << bounds_[i] << "\"} " << cumulative << "\n";
+        }
+        os << name << "_bucket{" << labels << separator << "le=\"+Inf\"} " << count_ << "\n";
+        os << name << "_sum" << braced(labels) << " " << sum_ << "\n";
+        os << name << "_count" << braced(labels) << " " << count_ << "\n";
+    }
+
+    static std::string braced(std::string const& labels) { return labels.empty() ? "" : "{" + labels + "}"; }
+
+  private:
+    std::vector<double> bounds_;
+    // Observations in each bucket alone. Prometheus buckets are cumulative, so are summed on output.
+    std::vector<uint64_t> counts_;
+    double sum_ = 0;
+    uint64_t count_ = 0;
+};
+
+/**
+ * Formats a label for a metric, e.g. `circuit="tx rollup"`.
+ */
+inline std::string label(std::string const& name, std::string const& value)
+{
+    std::string escaped;
+    for (auto c : value) {
+        if (c == '"' || c == '\\') {
+            escaped += '\\';
+        }
+        escaped += c == '\n' ? ' ' : c;
+    }
+    return name + "=\"" + escaped + "\"";
+}
+
+/**
+ * The metrics of a process, written out in Prometheus' text format.
+ *
+ * Metrics are created on first use, and each is identified by its name and labels. Thread safe, as circuits can be
+ * built on a worker thread while another is proven.
+ */
+class Registry {
+  public:
+    void observe(std::string const& name,
+                 std::string const& labels,
+                 double value,
+                 std::vector<double> const& buckets = duration_buckets())
+    {
+        auto lock = lock_metrics();
+        auto& series = histograms_[name];
+        auto it = series.find(labels);
+        if (it == series.end()) {
+            it = series.emplace(labels, Histogram(buckets)).first;
+        }
+        it->second.observe(value);
+    }
+
+    void increment(std::string const& name, std::string const& labels = "", uint64_t by = 1)
+    {
+        auto lock = lock_metrics();
+        counters_[name][labels] += by;
+    }
+
+    void set(std::string const& name, std::string const& labels, double value)
+    {
+        auto lock = lock_metrics();
+        gauges_[name][labels] = value;
+    }
+
+    void write(std::ostream& os) const
+    {
+        auto lock = lock_metrics();
+        // Enough digits that sums of many durations keep their millisecond precision.
+        auto precision = os.precision(12);
+        for (auto const& [name, series] : histograms_) {
+            os << "# TYPE " << name << " histogram\n";
+            for (auto const& [labels, histogram] : series) {
+                histogram.write(os, name, labels);
+            }
+        }
+        write_values(os, counters_, "counter");
+        write_values(os, gauges_, "gauge");
+        os.precision(precision);
+    }
+
+    std::string to_string() const
+    {
+        std::ostringstream os;
+        write(os);
+        return os.str();
+    }
+
+    /**
+     * Writes the metrics to a file, for node exporter's textfile collector. The file is replaced in one rename, so is
+     * never read half written.
+     */
+    bool export_to(std::string const& path) const
+    {
+        auto temp_path = path + ".tmp";
+        {
+            std::ofstream file(temp_path);
+            write(file);
+            if (!file.good()) {
+                return false;
+            }
+        }
+        return std::rename(temp_path.c_str(), path.c_str()) == 0;
+    }
+
+  private:
+#ifndef NO_MULTITHREADING
+    std::lock_guard<std::mutex> lock_metrics() const { return std::lock_guard<std::mutex>(mutex_); }
+#else
+    struct NoLock {
+        ~NoLock() {}
+    };
+    NoLock lock_metrics() const { return {}; }
+#endif
+
+    template <typename T>
+    static void write_values(std::ostream& os,
+                             std::map<std::string, std::map<std::string, T>> const& values,
+                             char const* type)
+    {
+        for (auto const& [name, series] : values) {
+            os << "# TYPE " << name << " " << type << "\n";
+            for (auto const& [labels, value] : series) {
+                os << name << Histogram::braced(labels) << " " << value << "\n";
+            }
+        }
+    }
+
+#ifndef NO_MULTITHREADING
+    mutable std::mutex mutex_;
+#endif
+    std::map<std::string, std::map<std::string, Histogram>> histograms_;
+    std::map<std::string, std::map<std::string, uint64_t>> counters_;
+    std::map<std::string, std::map<std::string, double>> gauges_;
+};
+
+inline Registry& registry()
+{
+    static Registry registry;
+    return registry;
+}
+
+/**
+ * Records the time from its construction to its destruction, or to `stop`, in a duration histogram.
+ */
+class ScopedTimer {
+  public:
+    ScopedTimer(std::string const& name, std::string const& labels = "")
+        : name_(name)
+        , labels_(labels)
+        , start_(std::chrono::steady_clock::now())
+    {}
+
+    ScopedTimer(ScopedTimer const&) = delete;
+    ScopedTimer& operator=(ScopedTimer const&) = delete;
+
+    ~ScopedTimer() { stop(); }
+
+    void stop()
+    {
+        if (stopped_) {
+            return;
+        }
+        stopped_ = true;
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start_;
+        registry().observe(name_, labels_, elapsed.count());
+    }
+
+  private:
+    std::string name_;
+    std::string labels_;
+    std::chrono::steady_clock::time_point start_;
+    bool stopped_ = false;
+};
+
+/**
+ * Exports the registry to a file at most once an interval. Clis call `tick` after each request, so the file is only
+ * rewritten when there's something new to put in it. A blank path disables exporting.
+ */
+class PeriodicExporter {
+  public:
+    PeriodicExporter(std::string const& path, std::chrono::seconds interval)
+        : path_(path)
+        , interval_(interval)
+    {}
+
+    void tick()
+    {
+        auto now = std::chrono::steady_clock::now();
+        if (!path_.empty() && now - last_export_ >= interval_) {
+            flush();
+            last_export_ = now;
+        }
+    }
+
+    void flush()
+    {
+        if (!path_.empty() && !registry().export_to(path_)) {
+            std::cerr << "Failed to export metrics to " << path_ << std::endl;
+        }
+    }
+
+  private:
+    std::string path_;
+    std::chrono::seconds interval_;
+    std::chrono::steady_clock::time_point last_export_;
+};
+
+} // namespace metrics
+} // namespace rollup
@@ -14,6 +14,8 @@ using namespace notes;
 
 void claim_circuit(Composer& composer, claim_tx const& tx)
 {
+    gate_profiler::Scope profile(composer, "claim_circuit");
+
     // Create witnesses.
     const auto proof_id = field_ct(witness_ct(&composer, ProofIds::DEFI_CLAIM));
     proof_id.assert_equal(ProofIds::DEFI_CLAIM);
@@ -112,6 +114,7 @@ void claim_circuit(Composer& composer, claim_tx const& tx)
     field_ct output_note_commitment2;
     {
         // Compute output notes.
+        gate_profiler::Scope profile(composer, "compute_output_notes");
         const auto virtual_note_flag = suint_ct(uint256_t(1) << (MAX_NUM_ASSETS_BIT_LENGTH - 1));
 
         // If the defi interaction was unsuccessful, refund the original defi_deposit_value (which was denominated in
@@ -162,6 +165,7 @@ void claim_circuit(Composer& composer, claim_tx const& tx)
 
     {
         // Existence checks
+        gate_profiler::Scope profile(composer, "check_notes_exist");
 
         // Check claim note exists:
         const bool_ct claim_exists = check_membership(data_root,
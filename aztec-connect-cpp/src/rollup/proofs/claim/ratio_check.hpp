@@ -1,5 +1,6 @@
 #pragma once
 #include "claim_tx.hpp"
+#include "../gate_profiler/gate_profiler.hpp"
 #include <stdlib/types/turbo.hpp>
 
 namespace rollup {
@@ -149,6 +150,7 @@ inline bool_ct product_check(Composer& composer,
  */
 inline bool_ct ratio_check(Composer& composer, ratios const& ratios)
 {
+    gate_profiler::Scope profile(composer, "ratio_check");
     const field_ct residual = ratios.get_residual(composer);
 
     return (ratios.a2 != 0) && (ratios.b2 != 0) &&
@@ -1,6 +1,7 @@
 #pragma once
 #include "join_split/join_split.hpp"
 #include "mock/mock_circuit.hpp"
+#include "../metrics/metrics.hpp"
 #include "../constants.hpp"
 #include <fstream>
 #include <sys/stat.h>
@@ -63,6 +64,7 @@ circuit_data get_circuit_data(std::string const& name,
     auto pk_path = circuit_key_path + "/proving_key/proving_key";
     auto vk_path = circuit_key_path + "/verification_key";
     auto padding_path = circuit_key_path + "/padding_proof";
+    auto circuit = metrics::label("circuit", name);
 
     // If we're missing required data, and compute is enabled, or if
     // compute is enabled and load is disabled, build the circuit.
@@ -106,6 +108,7 @@ circuit_data get_circuit_data(std::string const& name,
         auto pk_dir = circuit_key_path + "/proving_key";
         if (exists(pk_path) && load) {
             info(name, ": Loading proving key: ", pk_path);
+            metrics::ScopedTimer load_timer("rollup_key_load_seconds", circuit + ",key=\"proving\"");
             auto pk_stream = std::ifstream(pk_path);
             waffle::proving_key_data pk_data;
             read_mmap(pk_stream, pk_dir, pk_data);
@@ -167,6 +170,7 @@ circuit_data get_circuit_data(std::string const& name,
     if (vk) {
         if (exists(vk_path) && load) {
             info(name, ": Loading verification key from: ", vk_path);
+            metrics::ScopedTimer load_timer("rollup_key_load_seconds", circuit + ",key=\"verification\"");
             auto vk_stream = std::ifstream(vk_path);
             waffle::verification_key_data vk_data;
             read(vk_stream, vk_data);
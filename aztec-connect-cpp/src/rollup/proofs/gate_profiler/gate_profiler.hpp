@@ -0,0 +1,249 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+#ifndef NO_MULTITHREADING
+#include <mutex>
+#endif
+
+namespace rollup {
+namespace proofs {
+namespace gate_profiler {
+
+struct Region {
+    // Gates added within the region, over every time it was entered, including those of regions nested in it.
+    size_t gates = 0;
+    size_t calls = 0;
+};
+
+/**
+ * Attributes a circuit's gates to the regions of the circuit code that added them, to see what's worth optimising.
+ *
+ * Enabled by setting ROLLUP_GATE_PROFILE to a file path before running a test binary, e.g.
+ *
+ *   ROLLUP_GATE_PROFILE=rollup.profile ./bin/rollup_proofs_rollup_tests --gtest_filter=*test_1_proof_in_1_rollup
+ *
+ * On exit a report of the gates per call to each region is printed, and the profile is written to the path. If
+ * ROLLUP_GATE_PROFILE_BASELINE names the profile of an earlier run, the report includes the change from it. Regions
+ * are averaged over every time they're entered, so filter to tests that build the same circuit for a clean profile.
+ *
+ * Regions nest, and are identified by their path from the outermost, e.g. `rollup_circuit/verify_proof`. Circuits
+ * can be built on several threads at once: each thread has its own path of entered regions, and their gates are added
+ * to the profile under a lock. Enabling or disabling it while circuits are being built only affects regions entered
+ * afterwards.
+ */
+class Profiler {
+  public:
+    Profiler()
+    {
+        auto path = std::getenv("ROLLUP_GATE_PROFILE");
+        auto baseline_path = std::getenv("ROLLUP_GATE_PROFILE_BASELINE");
+        enabled_ = path && *path;
+        output_path_ = enabled() ? path : "";
+        baseline_path_ = baseline_path ? baseline_path : "";
+    }
+
+    ~Profiler()
+    {
+        if (!enabled() || regions_.empty()) {
+            return;
+        }
+        std::map<std::string, Region> baseline;
+        if (!baseline_path_.empty()) {
+            std::ifstream is(baseline_path_);
+            baseline = read(is);
+        }
+        report(std::cerr, baseline);
+        if (!output_path_.empty()) {
+            std::ofstream os(output_path_);
+            write(os);
+        }
+    }
+
+    bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+    void enable(bool enabled = true) { enabled_.store(enabled, std::memory_order_relaxed); }
+
+    void reset()
+    {
+        auto lock = lock_regions();
+        regions_.clear();
+    }
+
+    // Not to be called while circuits are being built.
+    std::map<std::string, Region> const& regions() const { return regions_; }
+
+    void enter(char const* name)
+    {
+        auto& path = entered();
+        path.push_back(path.empty() ? std::string(name) : path.back() + "/" + name);
+    }
+
+    void exit(size_t gates)
+    {
+        auto& path = entered();
+        {
+            auto lock = lock_regions();
+            auto& region = regions_[path.back()];
+            region.gates += gates;
+            ++region.calls;
+        }
+        path.pop_back();
+    }
+
+    /**
+     * Writes the profile as a line of `<path> <gates> <calls>` per region.
+     */
+    void write(std::ostream& os) const
+    {
+        for (auto const& [path, region] : regions_) {
+            os << path << " " << region.gates << " " << region.calls << "\n";
+        }
+    }
+
+    static std::map<std::string, Region> read(std::istream& is)
+    {
+        std::map<std::string, Region> regions;
+        std::string path;
+        Region region;
+        while (is >> path >> region.gates >> region.calls) {
+            regions[path] = region;
+        }
+        return regions;
+    }
+
+    /**
+     * Prints the regions as a tree, with the gates per call to each, those not in a nested region ("self"), and the
+     * change in gates per call from the baseline.
+     */
+    void report(std::ostream& os, std::map<std::string, Region> const& baseline = {}) const
+    {
+        os << std::left << std::setw(64) << "region" << std::right << std::setw(12) << "gates" << std::setw(12)
+           << "self" << std::setw(8) << "calls";
+        if (!baseline.empty()) {
+            os << std::setw(12) << "baseline" << std::setw(12) << "change";
+        }
+        os << "\n";
+
+        // Paths sort depth first, as '/' sorts before the characters of region names.
+        for (auto const& [path, region] : regions_) {
+            auto depth = static_cast<size_t>(std::count(path.begin(), path.end(), '/'));
+            auto name = path.substr(path.rfind('/') + 1);
+            auto gates = per_call(region);
+            os << std::left << std::setw(64) << (std::string(depth * 2, ' ') + name) << std::right << std::setw(12)
+               << gates << std::setw(12) << per_call({ region.gates - child_gates(path), region.calls })
+               << std::setw(8) << region.calls;
+            if (!baseline.empty()) {
+                auto it = baseline.find(path);
+                if (it == baseline.end()) {
+                    os << std::setw(12) << "-" << std::setw(12) << "new";
+                } else {
+                    auto baseline_gates = per_call(it->second);
+                    std::ostringstream change;
+                    change << std::showpos << static_cast<int64_t>(gates) - static_cast<int64_t>(baseline_gates);
+                    os << std::setw(12) << baseline_gates << std::setw(12) << change.str();
+                }
+            }
+            os << "\n";
+        }
+        for (auto const& [path, region] : baseline) {
+            if (!regions_.count(path)) {
+                os << std::left << std::setw(64) << path << std::right << std::setw(12) << "-" << std::setw(12) << "-"
+                   << std::setw(8) << "-" << std::setw(12) << per_call(region) << std::setw(12) << "removed"
+                   << "\n";
+            }
+        }
+    }
+
+  private:
+    // Paths of the regions this thread has entered and not yet exited, innermost last.
+    static std::vector<std::string>& entered()
+    {
+#ifndef NO_MULTITHREADING
+        thread_local std::vector<std::string> path;
+#else
+        static std::vector<std::string> path;
+#endif
+        return path;
+    }
+
+#ifndef NO_MULTITHREADING
+    std::lock_guard<std::mutex> lock_regions() { return std::lock_guard<std::mutex>(mutex_); }
+#else
+    struct NoLock {
+        ~NoLock() {}
+    };
+    NoLock lock_regions() { return {}; }
+#endif
+
+    static size_t per_call(Region const& region) { return region.calls ? region.gates / region.calls : 0; }
+
+    // Gates of the regions directly nested in the region at the path.
+    size_t child_gates(std::string const& path) const
+    {
+        size_t gates = 0;
+        auto prefix = path + "/";
+        for (auto it = regions_.lower_bound(prefix); it != regions_.end() && it->first.rfind(prefix, 0) == 0; ++it) {
+            if (it->first.find('/', prefix.size()) == std::string::npos) {
+                gates += it->second.gates;
+            }
+        }
+        return gates;
+    }
+
+    std::atomic<bool> enabled_;
+    std::string output_path_;
+    std::string baseline_path_;
+#ifndef NO_MULTITHREADING
+    std::mutex mutex_;
+#endif
+    std::map<std::string, Region> regions_;
+};
+
+inline Profiler& profiler()
+{
+    static Profiler profiler;
+    return profiler;
+}
+
+/**
+ * Attributes the gates added to the composer from its construction to its destruction to a region of the circuit.
+ */
+template <typename Composer> class Scope {
+  public:
+    Scope(Composer& composer, char const* name)
+        : composer_(composer)
+        , enabled_(profiler().enabled())
+        , start_(enabled_ ? composer.get_num_gates() : 0)
+    {
+        if (enabled_) {
+            profiler().enter(name);
+        }
+    }
+
+    Scope(Scope const&) = delete;
+    Scope& operator=(Scope const&) = delete;
+
+    ~Scope()
+    {
+        if (enabled_) {
+            profiler().exit(composer_.get_num_gates() - start_);
+        }
+    }
+
+  private:
+    Composer& composer_;
+    bool enabled_;
+    size_t start_;
+};
+
+} // namespace gate_profiler
+} // namespace proofs
+} // namespace rollup
@@ -0,0 +1,133 @@
+#include "gate_profiler.hpp"
+#include <common/test.hpp>
+#include <stdlib/types/turbo.hpp>
+#include <sstream>
+#ifndef NO_MULTITHREADING
+#include <thread>
+#endif
+
+using namespace plonk::stdlib::types::turbo;
+using namespace rollup::proofs::gate_profiler;
+
+namespace {
+
+// Adds a few gates to the composer, in a region of its own.
+size_t add_gates(Composer& composer, field_ct const& a, field_ct const& b)
+{
+    auto start = composer.get_num_gates();
+    Scope profile(composer, "add_gates");
+    (a * b + a).assert_equal(a * b + a);
+    return composer.get_num_gates() - start;
+}
+
+} // namespace
+
+// The profiler is process wide, so each test starts with it enabled and empty, and leaves it empty.
+class gate_profiler_tests : public ::testing::Test {
+  protected:
+    void SetUp() override
+    {
+        was_enabled_ = profiler().enabled();
+        profiler().reset();
+        profiler().enable();
+    }
+
+    void TearDown() override
+    {
+        profiler().enable(was_enabled_);
+        profiler().reset();
+    }
+
+  private:
+    bool was_enabled_;
+};
+
+TEST_F(gate_profiler_tests, gates_attributed_to_nested_regions)
+{
+    Composer composer = Composer("../barretenberg/cpp/srs_db/ignition");
+    field_ct a(witness_ct(&composer, 10));
+    field_ct b(witness_ct(&composer, 20));
+
+    auto start = composer.get_num_gates();
+    size_t inner_gates = 0;
+    {
+        Scope profile(composer, "outer");
+        inner_gates += add_gates(composer, a, b);
+        inner_gates += add_gates(composer, b, a);
+        (a + b).assert_equal(b + a);
+    }
+
+    auto const& regions = profiler().regions();
+    EXPECT_EQ(regions.at("outer").gates, composer.get_num_gates() - start);
+    EXPECT_EQ(regions.at("outer").calls, 1UL);
+    EXPECT_EQ(regions.at("outer/add_gates").gates, inner_gates);
+    EXPECT_EQ(regions.at("outer/add_gates").calls, 2UL);
+    EXPECT_EQ(regions.count("add_gates"), 0UL);
+}
+
+TEST_F(gate_profiler_tests, disabled_profiler_records_nothing)
+{
+    profiler().enable(false);
+    Composer composer = Composer("../barretenberg/cpp/srs_db/ignition");
+    field_ct a(witness_ct(&composer, 10));
+    add_gates(composer, a, a);
+    EXPECT_TRUE(profiler().regions().empty());
+}
+
+TEST_F(gate_profiler_tests, write_read_and_report)
+{
+    Composer composer = Composer("../barretenberg/cpp/srs_db/ignition");
+    field_ct a(witness_ct(&composer, 10));
+    size_t inner_gates = 0;
+    {
+        Scope profile(composer, "outer");
+        inner_gates = add_gates(composer, a, a);
+    }
+
+    // The profile reads back as written, and reports no change against itself.
+    std::stringstream profile;
+    profiler().write(profile);
+    auto baseline = Profiler::read(profile);
+    EXPECT_EQ(baseline.at("outer/add_gates").gates, inner_gates);
+    EXPECT_EQ(baseline.at("outer/add_gates").calls, 1UL);
+    std::stringstream report;
+    profiler().report(report, baseline);
+    EXPECT_NE(report.str().find("  add_gates "), std::string::npos);
+    EXPECT_EQ(report.str().find("new"), std::string::npos);
+    EXPECT_EQ(report.str().find("removed"), std::string::npos);
+
+    // Against a baseline missing a region, the region is reported as new, and one only in the baseline as removed.
+    baseline.erase("outer/add_gates");
+    baseline["outer/gone"] = Region{ 1, 1 };
+    std::stringstream changes;
+    profiler().report(changes, baseline);
+    EXPECT_NE(changes.str().find("new"), std::string::npos);
+    EXPECT_NE(changes.str().find("removed"), std::string::npos);
+}
+
+#ifndef NO_MULTITHREADING
+TEST_F(gate_profiler_tests, circuits_built_on_several_threads)
+{
+    size_t const num_threads = 4;
+    std::vector<size_t> inner_gates(num_threads);
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < num_threads; ++i) {
+        threads.emplace_back([&, i]() {
+            Composer composer = Composer("../barretenberg/cpp/srs_db/ignition");
+            field_ct a(witness_ct(&composer, i + 1));
+            Scope profile(composer, "outer");
+            inner_gates[i] = add_gates(composer, a, a);
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    // Each thread's regions nest under its own outer region, never another thread's.
+    auto const& regions = profiler().regions();
+    EXPECT_EQ(regions.size(), 2UL);
+    EXPECT_EQ(regions.at("outer").calls, num_threads);
+    EXPECT_EQ(regions.at("outer/add_gates").calls, num_threads);
+    EXPECT_EQ(regions.at("outer/add_gates").gates, inner_gates[0] * num_threads);
+}
+#endif
@@ -58,7 +58,7 @@ join_split_tx noop_tx()
     return tx;
 }
 
-circuit_data get_circuit_data(std::shared_ptr<waffle::ReferenceStringFactory> const& srs, bool mock)
+circuit_data get_circuit_data(std::shared_ptr<waffle::ReferenceStringFactory> const& srs, bool mock, bool padding)
 {
     std::cerr << "Getting join-split circuit data..." << std::endl;
 
@@ -68,7 +68,7 @@ circuit_data get_circuit_data(std::shared_ptr<waffle::ReferenceStringFactory> co
     };
 
     return proofs::get_circuit_data<Composer>(
-        "join split", "", srs, "", true, false, false, true, true, true, mock, build_circuit);
+        "join split", "", srs, "", true, false, false, true, true, padding, mock, build_circuit);
 }
 
 } // namespace join_split
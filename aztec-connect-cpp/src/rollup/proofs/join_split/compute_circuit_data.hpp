@@ -10,7 +10,12 @@ join_split_tx noop_tx();
 
 using circuit_data = proofs::circuit_data;
 
-circuit_data get_circuit_data(std::shared_ptr<waffle::ReferenceStringFactory> const& srs, bool mock = false);
+/**
+ * Without `padding`, the padding proof isn't made, and must be filled in before any tx rollup is built with the data.
+ */
+circuit_data get_circuit_data(std::shared_ptr<waffle::ReferenceStringFactory> const& srs,
+                              bool mock = false,
+                              bool padding = true);
 
 } // namespace join_split
 } // namespace proofs
@@ -5,6 +5,7 @@
 #include "../notes/circuit/account/account_note.hpp"
 #include "../notes/circuit/claim/claim_note.hpp"
 #include "verify_signature.hpp"
+#include "../gate_profiler/gate_profiler.hpp"
 #include <stdlib/merkle_tree/membership.hpp>
 #include <stdlib/primitives/field/pow.hpp>
 
@@ -31,6 +32,7 @@ field_ct process_input_note(field_ct const& account_private_key,
                             bool_ct is_propagated,
                             bool_ct is_note_in_use)
 {
+    gate_profiler::Scope profile(*merkle_root.context, "process_input_note");
     const bool_ct valid_value = note.value == 0 || is_note_in_use;
     valid_value.assert_equal(true, "padding note non zero");
 
@@ -44,6 +46,10 @@ field_ct process_input_note(field_ct const& account_private_key,
 
 join_split_outputs join_split_circuit_component(join_split_inputs const& inputs)
 {
+    // The merkle root is always a witness, so has the composer.
+    auto& composer = *inputs.merkle_root.context;
+    gate_profiler::Scope profile(composer, "join_split_circuit_component");
+
     const bool_ct is_deposit = inputs.proof_id == field_ct(ProofIds::DEPOSIT);
     const bool_ct is_withdraw = inputs.proof_id == field_ct(ProofIds::WITHDRAW);
     const bool_ct is_send = inputs.proof_id == field_ct(ProofIds::SEND);
@@ -216,6 +222,7 @@ join_split_outputs join_split_circuit_component(join_split_inputs const& inputs)
 
     // Verify that the signing key account note exists if account_required == true.
     {
+        gate_profiler::Scope profile(composer, "check_account_note");
         const auto account_alias_hash = inputs.alias_hash;
         const auto account_note_data = account::account_note(account_alias_hash.value, account_public_key, signer);
         const bool_ct signing_key_exists =
@@ -254,17 +261,21 @@ join_split_outputs join_split_circuit_component(join_split_inputs const& inputs)
     // A: By passing a signature to the circuit, the 'signing private key' doesn't need to be passed to the proof
     // construction software. This is useful for multisigs, offline signing, etc., so that the proof construction
     // software (or machine) doesn't have access to the signing private key.
-    const bool_ct verified = verify_signature(inputs.public_value.value,
-                                              inputs.public_owner,
-                                              public_asset_id.value,
-                                              output_note_1_commitment,
-                                              output_note_2.commitment,
-                                              nullifier1,
-                                              nullifier2,
-                                              signer,
-                                              inputs.backward_link,
-                                              inputs.allow_chain,
-                                              inputs.signature);
+    bool_ct verified;
+    {
+        gate_profiler::Scope profile(composer, "verify_signature");
+        verified = verify_signature(inputs.public_value.value,
+                                    inputs.public_owner,
+                                    public_asset_id.value,
+                                    output_note_1_commitment,
+                                    output_note_2.commitment,
+                                    nullifier1,
+                                    nullifier2,
+                                    signer,
+                                    inputs.backward_link,
+                                    inputs.allow_chain,
+                                    inputs.signature);
+    }
     // is_same_owner: we rely on input_note_1.owner == input_note_2.owner being checked already
     const bool_ct is_same_owner =
         input_note_1.owner == output_note_1.owner && input_note_2.owner == output_note_2.owner;
@@ -288,6 +299,7 @@ join_split_outputs join_split_circuit_component(join_split_inputs const& inputs)
 
 void join_split_circuit(Composer& composer, join_split_tx const& tx)
 {
+    gate_profiler::Scope profile(composer, "join_split_circuit");
     join_split_inputs inputs = {
         .proof_id = witness_ct(&composer, tx.proof_id),
         .public_value = suint_ct(witness_ct(&composer, tx.public_value), NOTE_VALUE_BIT_LENGTH, "public_value"),
@@ -0,0 +1,64 @@
+#pragma once
+#include <stdlib/types/turbo.hpp>
+
+namespace rollup {
+namespace proofs {
+
+using namespace plonk::stdlib::types::turbo;
+
+/**
+ * Returns a prover supplied one-hot selector over `table`, constrained such that:
+ * - if `is_active` is false, no entry is selected,
+ * - if `is_active` is true, exactly one entry is selected and it equals `value`.
+ *
+ * This costs a boolean and an inner product term per table entry, rather than an equality check per entry.
+ * If several entries equal `value` the prover is free to select any of them, so callers must ensure the selected
+ * table entries are unique (see `assert_selected_entries_unique`).
+ */
+inline std::vector<bool_ct> one_hot_select(Composer& composer,
+                                           field_ct const& value,
+                                           std::vector<field_ct> const& table,
+                                           bool_ct const& is_active,
+                                           std::string const& msg)
+{
+    std::vector<bool_ct> selector;
+    std::vector<field_ct> selected_bits;
+    std::vector<field_ct> selected_terms;
+    bool found = false;
+    for (auto const& entry : table) {
+        const bool is_selected = is_active.get_value() && !found && entry.get_value() == value.get_value();
+        found |= is_selected;
+
+        selector.push_back(witness_ct(&composer, is_selected));
+        selected_bits.push_back(field_ct(selector.back()));
+        selected_terms.push_back(field_ct(selector.back()) * entry);
+    }
+
+    field_ct::accumulate(selected_bits).assert_equal(field_ct(is_active), msg);
+    field_ct::accumulate(selected_terms).assert_equal(value * field_ct(is_active), msg);
+    return selector;
+}
+
+/**
+ * Asserts that no entry of `table` with non zero `uses`, the count of `one_hot_select` selections of it, equals another
+ * entry. So every value selected matched exactly one entry, as comparing it with every entry would show. Entries that
+ * were never selected may repeat.
+ */
+inline void assert_selected_entries_unique(std::vector<field_ct> const& table,
+                                           std::vector<field_ct> const& uses,
+                                           std::string const& msg)
+{
+    std::vector<bool_ct> used;
+    for (auto const& count : uses) {
+        used.push_back(!count.is_zero());
+    }
+    for (size_t i = 0; i < table.size(); ++i) {
+        for (size_t j = i + 1; j < table.size(); ++j) {
+            auto valid = !(used[i] || used[j]) || table[i] != table[j];
+            valid.assert_equal(true, format(msg, " at ", i, " and ", j));
+        }
+    }
+}
+
+} // namespace proofs
+} // namespace rollup
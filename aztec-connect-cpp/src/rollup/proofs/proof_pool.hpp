@@ -0,0 +1,350 @@
+#pragma once
+#include <common/log.hpp>
+#include <common/throw_or_abort.hpp>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#ifdef __linux__
+#include <sys/resource.h>
+#endif
+
+namespace rollup {
+namespace proofs {
+
+/**
+ * Precomputes throwaway proofs, such as noop join-splits and padding proofs, on background threads so they're ready
+ * when asked for.
+ *
+ * Each kind of proof is a source. One registered with `add` has a target depth, which workers keep it topped up to,
+ * and each of its proofs is served once by `take`. One registered with `add_shared` has a single proof, such as a
+ * circuit's padding proof, which `get` serves to every caller. If a path is given, proofs are persisted under
+ * `<path>/<source>/` as they're made, and removed as they're taken, so a later run starts with what an earlier one
+ * left. Proofs that are only valid against some state or circuit, such as a data root or a verification key, should
+ * include it in the source name.
+ *
+ * Workers run at the lowest scheduling priority, so only use cores that would otherwise be idle. Provers write to
+ * their proving key, so `make` is given the index of the worker calling it, to prove with that worker's own keys, and
+ * must otherwise keep its keys from being proven with elsewhere at the same time. Workers call `make` until the pool is
+ * destroyed, so anything it uses by reference must outlive the pool.
+ *
+ * tx_factory pools its noop join-splits, and rollup_cli the padding proofs of its join-split and tx rollup circuits.
+ * tx_load's client proofs spend notes created by earlier blocks, so can't be made ahead of its state. The account and
+ * claim circuits have no padding proofs, and a root rollup's is only used to build the root verifier's keys, so is
+ * made along with them.
+ */
+class ProofPool {
+  public:
+    using Make = std::function<std::vector<uint8_t>(size_t worker)>;
+
+    ProofPool(std::string const& path, size_t num_workers)
+        : path_(path)
+    {
+        if (num_workers == 0) {
+            throw_or_abort("A proof pool needs at least one worker.");
+        }
+        for (size_t i = 0; i < num_workers; ++i) {
+            workers_.emplace_back([this, i]() { work(i); });
+        }
+    }
+
+    ProofPool(ProofPool const&) = delete;
+    ProofPool& operator=(ProofPool const&) = delete;
+
+    /**
+     * Stops the workers, and fails any call waiting on a proof.
+     */
+    ~ProofPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        changed_.notify_all();
+        for (auto& worker : workers_) {
+            worker.join();
+        }
+        {
+            // Waiters wake to find the pool stopping, and must be gone before it's destroyed.
+            std::unique_lock<std::mutex> lock(mutex_);
+            changed_.wait(lock, [&]() { return waiters_ == 0; });
+        }
+        for (auto const& [name, source] : sources_) {
+            info("Proof pool ", name, ": ", source.hits, " hits, ", source.misses, " misses, ", source.ready.size(),
+                 " left.");
+        }
+    }
+
+    /**
+     * Registers a source of proofs, loading any persisted for it, and starts filling it to `target`.
+     */
+    void add(std::string const& name, size_t target, Make make) { add_source(name, target, std::move(make), false); }
+
+    /**
+     * Registers a source of one proof, loading it if it's persisted, and starts making it if not. Once it's made,
+     * `make` is released, along with any keys it holds.
+     */
+    void add_shared(std::string const& name, Make make) { add_source(name, 1, std::move(make), true); }
+
+    bool has(std::string const& name)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return sources_.count(name) != 0;
+    }
+
+    /**
+     * Returns a proof from the source, waiting for one to be made if it's empty.
+     */
+    std::vector<uint8_t> take(std::string const& name)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        auto& source = find(name);
+        if (source.shared) {
+            throw_or_abort("Proof pool source is shared, so its proof can't be taken: " + name);
+        }
+        wait_for_proof(lock, name, source);
+        auto proof = std::move(source.ready.front());
+        source.ready.pop_front();
+        if (!proof.file.empty()) {
+            std::error_code error;
+            std::filesystem::remove(proof.file, error);
+        }
+        changed_.notify_all();
+        return std::move(proof.data);
+    }
+
+    /**
+     * Returns a copy of a shared source's proof, waiting for it to be made if it hasn't been.
+     */
+    std::vector<uint8_t> get(std::string const& name)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        auto& source = find(name);
+        if (!source.shared) {
+            throw_or_abort("Proof pool source isn't shared, so its proofs must be taken: " + name);
+        }
+        wait_for_proof(lock, name, source);
+        return source.ready.front().data;
+    }
+
+    size_t size(std::string const& name)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = sources_.find(name);
+        return it == sources_.end() ? 0 : it->second.ready.size();
+    }
+
+    /**
+     * Waits for every source to reach its target.
+     */
+    void wait_until_full()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        changed_.wait(lock, [&]() {
+            for (auto const& [name, source] : sources_) {
+                if (source.ready.size() < source.target) {
+                    return false;
+                }
+            }
+            return true;
+        });
+    }
+
+  private:
+    struct Proof {
+        // Where the proof is persisted, if it is.
+        std::string file;
+        std::vector<uint8_t> data;
+    };
+
+    struct Source {
+        size_t target = 0;
+        Make make;
+        bool shared = false;
+        std::deque<Proof> ready;
+        // Proofs being made by workers.
+        size_t in_flight = 0;
+        // Callers of `take` or `get` waiting on the source.
+        size_t wanted = 0;
+        size_t next_file = 0;
+        size_t hits = 0;
+        size_t misses = 0;
+    };
+
+    void add_source(std::string const& name, size_t target, Make make, bool shared)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (sources_.count(name)) {
+            throw_or_abort("Proof pool source already added: " + name);
+        }
+        auto& source = sources_[name];
+        source.target = target;
+        source.make = std::move(make);
+        source.shared = shared;
+        if (!path_.empty()) {
+            load(name, source);
+        }
+        if (shared && !source.ready.empty()) {
+            source.make = nullptr;
+        }
+        info("Proof pool ", name, ": loaded ", source.ready.size(), " of ", target, " proofs.");
+        changed_.notify_all();
+    }
+
+    Source& find(std::string const& name)
+    {
+        auto it = sources_.find(name);
+        if (it == sources_.end()) {
+            throw_or_abort("Unknown proof pool source: " + name);
+        }
+        return it->second;
+    }
+
+    /**
+     * Waits for the source to have a proof, asking the workers for one if it's empty. Fails if the pool is destroyed
+     * first.
+     */
+    void wait_for_proof(std::unique_lock<std::mutex>& lock, std::string const& name, Source& source)
+    {
+        if (!source.ready.empty()) {
+            source.hits++;
+            return;
+        }
+        source.misses++;
+        // Workers fill sources below their target, which an empty one always is unless its target is 0.
+        source.wanted++;
+        waiters_++;
+        changed_.notify_all();
+        changed_.wait(lock, [&]() { return stopping_ || !source.ready.empty(); });
+        source.wanted--;
+        waiters_--;
+        // Wakes the destructor, if it's waiting for the last waiter to leave.
+        changed_.notify_all();
+        if (source.ready.empty()) {
+            lock.unlock();
+            throw_or_abort("Proof pool stopped before making a proof for: " + name);
+        }
+    }
+
+    void load(std::string const& name, Source& source)
+    {
+        auto dir = std::filesystem::path(path_) / name;
+        std::filesystem::create_directories(dir);
+        std::map<size_t, std::filesystem::path> files;
+        for (auto const& entry : std::filesystem::directory_iterator(dir)) {
+            auto stem = entry.path().filename().string();
+            if (entry.is_regular_file() && stem.find_first_not_of("0123456789") == std::string::npos) {
+                files[std::stoul(stem)] = entry.path();
+            }
+        }
+        for (auto const& [index, file] : files) {
+            std::ifstream is(file, std::ios::binary);
+            std::vector<uint8_t> data((std::istreambuf_iterator<char>(is)), std::istreambuf_iterator<char>());
+            source.ready.push_back({ file.string(), std::move(data) });
+            source.next_file = index + 1;
+        }
+    }
+
+    /**
+     * Writes a proof to the source's directory, returning its file, or a blank path if it couldn't be written. Runs on
+     * a worker, so a failure is only logged: the proof is still served, but won't be there for the next run.
+     */
+    std::string persist(std::string const& name, size_t index, std::vector<uint8_t> const& data)
+    {
+        auto file = std::filesystem::path(path_) / name / std::to_string(index);
+        // Written aside and renamed, so a run that's killed mid write doesn't leave a truncated proof to be loaded.
+        auto partial = file.string() + ".partial";
+        std::error_code error;
+        {
+            std::ofstream os(partial, std::ios::binary);
+            os.write(reinterpret_cast<char const*>(data.data()), static_cast<std::streamsize>(data.size()));
+            if (!os.good()) {
+                error = std::make_error_code(std::errc::io_error);
+            }
+        }
+        if (!error) {
+            std::filesystem::rename(partial, file, error);
+        }
+        if (error) {
+            info("Proof pool ", name, ": failed to persist ", file.string(), ": ", error.message());
+            std::filesystem::remove(partial, error);
+            return "";
+        }
+        return file.string();
+    }
+
+    /**
+     * The source most in need of a proof: one being waited on, else the emptiest relative to its target.
+     */
+    Source* next_source(std::string& name)
+    {
+        Source* next = nullptr;
+        double next_fill = 1;
+        for (auto& [source_name, source] : sources_) {
+            auto depth = source.ready.size() + source.in_flight;
+            // A shared source's one proof is made once, however many are waiting on it.
+            if (source.wanted > depth && !source.shared) {
+                name = source_name;
+                return &source;
+            }
+            if (depth >= source.target) {
+                continue;
+            }
+            auto fill = static_cast<double>(depth) / static_cast<double>(source.target);
+            if (fill < next_fill) {
+                next_fill = fill;
+                next = &source;
+                name = source_name;
+            }
+        }
+        return next;
+    }
+
+    void work(size_t worker)
+    {
+#ifdef __linux__
+        // Linux niceness is per thread, so this leaves the rest of the process's threads as they are.
+        setpriority(PRIO_PROCESS, 0, 19);
+#endif
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true) {
+            std::string name;
+            Source* source = nullptr;
+            changed_.wait(lock, [&]() { return stopping_ || (source = next_source(name)) != nullptr; });
+            if (stopping_) {
+                return;
+            }
+            source->in_flight++;
+            auto index = source->next_file++;
+            lock.unlock();
+            auto data = source->make(worker);
+            auto file = path_.empty() ? "" : persist(name, index, data);
+            lock.lock();
+            source->in_flight--;
+            source->ready.push_back({ file, std::move(data) });
+            if (source->shared) {
+                source->make = nullptr;
+            }
+            changed_.notify_all();
+        }
+    }
+
+    std::string path_;
+    std::mutex mutex_;
+    std::condition_variable changed_;
+    // Sources are never removed, so pointers to them stay valid.
+    std::map<std::string, Source> sources_;
+    std::vector<std::thread> workers_;
+    bool stopping_ = false;
+    // Callers of `take` and `get` waiting on a proof.
+    size_t waiters_ = 0;
+};
+
+} // namespace proofs
+} // namespace rollup
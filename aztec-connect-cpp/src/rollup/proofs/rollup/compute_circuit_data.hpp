@@ -17,8 +17,15 @@ struct circuit_data : proofs::circuit_data {
     size_t num_txs;
     std::vector<std::shared_ptr<waffle::verification_key>> verification_keys;
     join_split::circuit_data join_split_circuit_data;
+    // Whether the circuit was built with `rollup_circuit`'s `select_matches`, as must the root rollups over it.
+    bool select_matches = false;
 };
 
+/**
+ * Without `padding`, the padding proof isn't made, and must be filled in before a root rollup is built with the data.
+ * With `select_matches`, the circuit matches asset ids and bridge call datas by prover selected entries, and its keys
+ * are kept apart from those of the default circuit.
+ */
 inline circuit_data get_circuit_data(size_t rollup_size,
                                      join_split::circuit_data const& join_split_circuit_data,
                                      account::circuit_data const& account_circuit_data,
@@ -30,13 +37,15 @@ inline circuit_data get_circuit_data(size_t rollup_size,
                                      bool load = true,
                                      bool pk = true,
                                      bool vk = true,
-                                     bool mock = false)
+                                     bool mock = false,
+                                     bool padding = true,
+                                     bool select_matches = false)
 {
     auto floor_max_txs = 1UL << numeric::get_msb(rollup_size);
     auto rollup_size_pow2 = rollup_size == floor_max_txs ? rollup_size : floor_max_txs << 1UL;
     std::cerr << "Getting tx rollup circuit data: (txs: " << rollup_size << ", size: " << rollup_size_pow2 << ")"
               << std::endl;
-    auto name = "rollup_" + std::to_string(rollup_size);
+    auto name = "rollup_" + std::to_string(rollup_size) + (select_matches ? "_selected" : "");
     auto verification_keys = { join_split_circuit_data.verification_key, // padding
                                join_split_circuit_data.verification_key, // deposit
                                join_split_circuit_data.verification_key, // withdraw
@@ -47,7 +56,7 @@ inline circuit_data get_circuit_data(size_t rollup_size,
 
     auto build_circuit = [&](Composer& composer) {
         auto rollup = create_padding_rollup(rollup_size, join_split_circuit_data.padding_proof);
-        rollup_circuit(composer, rollup, verification_keys, rollup_size);
+        rollup_circuit(composer, rollup, verification_keys, rollup_size, select_matches);
     };
 
     auto cd =
@@ -60,7 +69,7 @@ inline circuit_data get_circuit_data(size_t rollup_size,
                                            load,
                                            pk,
                                            vk,
-                                           true,
+                                           padding,
                                            mock,
                                            build_circuit,
                                            " " + std::to_string(rollup_size) + "x" + std::to_string(rollup_size_pow2));
@@ -74,6 +83,7 @@ inline circuit_data get_circuit_data(size_t rollup_size,
     data.num_txs = rollup_size;
     data.rollup_size = rollup_size_pow2;
     data.join_split_circuit_data = join_split_circuit_data;
+    data.select_matches = select_matches;
     data.srs = cd.srs;
     data.mock = cd.mock;
 
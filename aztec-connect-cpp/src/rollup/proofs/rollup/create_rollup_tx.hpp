@@ -129,6 +129,7 @@ inline rollup_tx create_rollup_tx(WorldState& world_state,
     std::vector<uint256_t> nullifier_indicies;
     std::vector<fr> data_tree_values;
 
+    // Indices not given are looked up in the world state, falling back to the latest leaf if not found.
     std::vector<uint32_t> linked_commitment_indices(linked_commitment_indices_);
     linked_commitment_indices.resize(num_txs, data_tree_size - 1);
     std::vector<uint32_t> data_roots_indicies(data_roots_indicies_);
@@ -137,6 +138,10 @@ inline rollup_tx create_rollup_tx(WorldState& world_state,
     for (size_t i = 0; i < num_txs; ++i) {
         auto tx = inner_proof_data(txs[i]);
 
+        if (i >= data_roots_indicies_.size()) {
+            data_roots_indicies[i] = world_state.find_data_root_index(tx.merkle_root).value_or(data_roots_indicies[i]);
+        }
+
         // Chaining - identify 'split chains' and push a valid merkle membership path.
         fr_hash_path linked_commitment_path;
         const bool chaining = tx.backward_link != 0;
@@ -161,6 +166,10 @@ inline rollup_tx create_rollup_tx(WorldState& world_state,
             if (start_of_subchain) {
                 // Then no earlier txs in this tx's chain have been included in this rollup, so we'll need to provide a
                 // valid merkle membership witness for the input note being propagated:
+                if (i >= linked_commitment_indices_.size()) {
+                    linked_commitment_indices[i] =
+                        world_state.find_commitment_index(tx.backward_link).value_or(linked_commitment_indices[i]);
+                }
                 linked_commitment_paths.push_back(data_tree.get_hash_path(linked_commitment_indices[i]));
             } else {
                 // This tx is not the first tx of its chain to be included in this rollup, hence the existence of the
@@ -3,7 +3,10 @@
 #include "../../constants.hpp"
 #include "../inner_proof_data/inner_proof_data.hpp"
 #include "../add_zero_public_inputs.hpp"
+#include "../gate_profiler/gate_profiler.hpp"
+#include "../one_hot_select.hpp"
 #include "../notes/circuit/claim/index.hpp"
+#include "../../trace/trace.hpp"
 #include <stdlib/merkle_tree/index.hpp>
 #include <stdlib/hash/sha256/sha256.hpp>
 #include <common/map.hpp>
@@ -28,6 +31,7 @@ field_ct check_nullifiers_inserted(Composer& composer,
                                    field_ct latest_null_root,
                                    std::vector<field_ct> const& new_null_indicies)
 {
+    gate_profiler::Scope profile(composer, "check_nullifiers_inserted");
     for (size_t i = 0; i < new_null_indicies.size(); ++i) {
         auto is_real = num_txs > uint32_ct(&composer, i / 2) && new_null_indicies[i] != 0;
 
@@ -54,14 +58,23 @@ field_ct check_nullifiers_inserted(Composer& composer,
  * - Ensure that the bridge_call_data matches one within the of set of bridge_call_datas.
  * - Accumulate the deposit value in relevant defi_deposit_sums slot. These later become public inputs.
  * - Modify the claim note commitment (output_note_1 commitment) to add the relevant interaction nonce to it.
+ *
+ * With `select_matches`, the prover selects the bridge call data the deposit matches from
+ * `selectable_bridge_call_datas` rather than it being compared with every in scope one. `bridge_call_data_uses` counts
+ * the selections of each, for `assert_selected_entries_unique` to check the selected one was the only match once all
+ * txs are processed.
  */
 auto process_defi_deposit(Composer& composer,
                           field_ct const& rollup_id,
                           std::vector<field_ct>& public_inputs,
                           std::vector<suint_ct> const& bridge_call_datas,
                           std::vector<suint_ct>& defi_deposit_sums,
-                          field_ct const& num_defi_interactions)
+                          field_ct const& num_defi_interactions,
+                          bool select_matches,
+                          std::vector<field_ct> const& selectable_bridge_call_datas,
+                          std::vector<field_ct>& bridge_call_data_uses)
 {
+    gate_profiler::Scope profile(composer, "process_defi_deposit");
     field_ct defi_interaction_nonce = (rollup_id * NUM_BRIDGE_CALLS_PER_BLOCK);
 
     const auto proof_id = public_inputs[InnerProofFields::PROOF_ID];
@@ -78,23 +91,38 @@ auto process_defi_deposit(Composer& composer,
      * Then the defi_interaction_nonce = rollup_id * NUM_BRIDGE_CALLS_PER_BLOCK + k.
      */
     field_ct note_defi_interaction_nonce = defi_interaction_nonce;
-    field_ct num_matched(&composer, 0);
 
-    for (uint32_t k = 0; k < NUM_BRIDGE_CALLS_PER_BLOCK; k++) {
-        auto is_real = uint32_ct(k) < num_defi_interactions;
+    if (select_matches) {
+        auto matches = one_hot_select(composer,
+                                      bridge_call_data.value,
+                                      selectable_bridge_call_datas,
+                                      is_defi_deposit,
+                                      "proof bridge call data did not match a single bridge call data");
+        for (uint32_t k = 0; k < NUM_BRIDGE_CALLS_PER_BLOCK; k++) {
+            defi_deposit_sums[k] += deposit_value * static_cast<suint_ct>(matches[k]);
+            note_defi_interaction_nonce += (field_ct(&composer, k) * matches[k]);
+            bridge_call_data_uses[k] += field_ct(matches[k]);
+        }
+        note_defi_interaction_nonce *= is_defi_deposit;
+    } else {
+        field_ct num_matched(&composer, 0);
 
-        const auto matches = bridge_call_data == bridge_call_datas[k] && is_real;
-        num_matched += matches;
+        for (uint32_t k = 0; k < NUM_BRIDGE_CALLS_PER_BLOCK; k++) {
+            auto is_real = uint32_ct(k) < num_defi_interactions;
 
-        defi_deposit_sums[k] += deposit_value * is_defi_deposit * matches;
-        note_defi_interaction_nonce += (field_ct(&composer, k) * matches);
-    }
-    note_defi_interaction_nonce *= is_defi_deposit;
+            const auto matches = bridge_call_data == bridge_call_datas[k] && is_real;
+            num_matched += matches;
 
-    // Assert this proof matched a single bridge_call_data.
-    auto is_valid_bridge_call_data = num_matched == 1 || !is_defi_deposit;
-    is_valid_bridge_call_data.assert_equal(
-        true, format("proof bridge call data matched ", uint64_t(num_matched.get_value()), " times"));
+            defi_deposit_sums[k] += deposit_value * is_defi_deposit * matches;
+            note_defi_interaction_nonce += (field_ct(&composer, k) * matches);
+        }
+        note_defi_interaction_nonce *= is_defi_deposit;
+
+        // Assert this proof matched a single bridge_call_data.
+        auto is_valid_bridge_call_data = num_matched == 1 || !is_defi_deposit;
+        is_valid_bridge_call_data.assert_equal(
+            true, format("proof bridge call data matched ", uint64_t(num_matched.get_value()), " times"));
+    }
 
     // Compute claim fee which to be added to the claim note.
     const suint_ct tx_fee(public_inputs[InnerProofFields::TX_FEE], TX_FEE_BIT_LENGTH, "tx_fee");
@@ -219,6 +247,10 @@ void process_chained_txs(size_t const& i,
 
 /**
  * Accumulate tx fees from each inner proof depending on the type of proof.
+ *
+ * With `select_matches`, the prover says whether the fee's asset id is one of `asset_ids`, and if so selects it, rather
+ * than it being compared with every in scope asset id. An asset id said not to be listed must differ from all of them,
+ * so the product of the differences is checked to be non zero. `asset_id_uses` is as for bridge call datas.
  */
 void accumulate_tx_fees(Composer& composer,
                         std::vector<suint_ct>& total_tx_fees,
@@ -227,10 +259,37 @@ void accumulate_tx_fees(Composer& composer,
                         suint_ct const& tx_fee,
                         std::vector<field_ct> const& asset_ids,
                         field_ct const& num_asset_ids,
-                        bool_ct const& is_real)
+                        bool_ct const& is_real,
+                        bool select_matches,
+                        std::vector<field_ct>& asset_id_uses)
 {
+    gate_profiler::Scope profile(composer, "accumulate_tx_fees");
     const auto is_account = proof_id == field_ct(ProofIds::ACCOUNT);
 
+    if (select_matches) {
+        // Out of scope asset ids are MAX_NUM_ASSETS, which no fee's asset id can be, so they're left in the table.
+        bool is_listed = false;
+        for (auto const& listed_asset_id : asset_ids) {
+            is_listed |= listed_asset_id.get_value() == asset_id.get_value();
+        }
+        const bool_ct is_matched(witness_ct(&composer, is_real.get_value() && !is_account.get_value() && is_listed));
+        auto matches = one_hot_select(
+            composer, asset_id, asset_ids, is_matched, "proof asset id did not match a single asset id");
+
+        field_ct differences = asset_id - asset_ids[0];
+        for (uint32_t k = 1; k < NUM_ASSETS; k++) {
+            differences *= (asset_id - asset_ids[k]);
+        }
+        auto is_valid_asset_id = !is_real || is_account || is_matched || differences != 0;
+        is_valid_asset_id.assert_equal(true, "proof asset id is listed but not selected");
+
+        for (uint32_t k = 0; k < NUM_ASSETS; k++) {
+            total_tx_fees[k] += tx_fee * static_cast<suint_ct>(matches[k]);
+            asset_id_uses[k] += field_ct(matches[k]);
+        }
+        return;
+    }
+
     // Accumulate tx_fee for each asset_id. Note that tx_fee = 0 for padding proofs.
     field_ct num_matched(&composer, 0);
     for (uint32_t k = 0; k < NUM_ASSETS; k++) {
@@ -251,8 +310,11 @@ void accumulate_tx_fees(Composer& composer,
 recursion_output<bn254> rollup_circuit(Composer& composer,
                                        rollup_tx const& rollup,
                                        std::vector<std::shared_ptr<waffle::verification_key>> const& verification_keys,
-                                       size_t max_num_txs)
+                                       size_t max_num_txs,
+                                       bool select_matches)
 {
+    gate_profiler::Scope profile(composer, "rollup_circuit");
+
     // Compute a constant witness of the next power of 2 > max_num_txs.
     const auto floor_rollup_size = 1UL << numeric::get_msb(max_num_txs);
     const auto rollup_size_pow2_ = floor_rollup_size << (max_num_txs != floor_rollup_size);
@@ -295,11 +357,18 @@ recursion_output<bn254> rollup_circuit(Composer& composer,
     const auto num_asset_ids = field_ct(witness_ct(&composer, rollup.num_asset_ids));
     auto asset_ids = map(rollup.asset_ids, [&](auto& aid) { return field_ct(witness_ct(&composer, aid)); });
     // Zero any input bridge_call_datas that are outside scope, and check in scope bridge_call_datas are not zero.
+    // Selected matching needs a table in which out of scope entries can't match, so they're one past the largest
+    // bridge call data there.
+    std::vector<field_ct> selectable_bridge_call_datas;
     for (uint32_t i = 0; i < NUM_BRIDGE_CALLS_PER_BLOCK; i++) {
         auto in_scope = uint32_ct(i) < num_defi_interactions;
         bridge_call_datas[i] *= in_scope;
         auto valid = !in_scope || bridge_call_datas[i] != 0;
         valid.assert_equal(true, "bridge_call_data out of scope");
+        if (select_matches) {
+            selectable_bridge_call_datas.push_back(field_ct::conditional_assign(
+                in_scope, bridge_call_datas[i].value, field_ct(fr(uint256_t(1) << DEFI_BRIDGE_CALL_DATA_BIT_LENGTH))));
+        }
     }
 
     // Input asset_ids that are outside scope are set to 2^{30} (NUM_MAX_ASSETS).
@@ -323,6 +392,8 @@ recursion_output<bn254> rollup_circuit(Composer& composer,
     auto total_tx_fees = std::vector<suint_ct>(NUM_ASSETS, suint_ct::create_constant_witness(&composer, 0));
     std::vector<suint_ct> defi_deposit_sums(NUM_BRIDGE_CALLS_PER_BLOCK,
                                             suint_ct::create_constant_witness(&composer, 0));
+    std::vector<field_ct> asset_id_uses(NUM_ASSETS, field_ct(&composer, 0));
+    std::vector<field_ct> bridge_call_data_uses(NUM_BRIDGE_CALLS_PER_BLOCK, field_ct(&composer, 0));
 
     for (size_t i = 0; i < max_num_txs; ++i) {
         // Pick verification key and check it's permitted.
@@ -332,12 +403,13 @@ recursion_output<bn254> rollup_circuit(Composer& composer,
         recursive_verification_key->validate_key_is_in_set(verification_keys);
 
         // Verify the inner proof.
-        recursion_output =
-            verify_proof<bn254, recursive_turbo_verifier_settings<bn254>>(&composer,
-                                                                          recursive_verification_key,
-                                                                          recursive_manifest,
-                                                                          waffle::plonk_proof{ rollup.txs[i] },
-                                                                          recursion_output);
+        {
+            trace::Span span("verify inner proof", "circuit", "tx", i);
+            gate_profiler::Scope profile(composer, "verify_proof");
+            recursion_output = verify_proof<bn254, recursive_turbo_verifier_settings<bn254>>(
+                &composer, recursive_verification_key, recursive_manifest, waffle::plonk_proof{ rollup.txs[i] },
+                recursion_output);
+        }
 
         auto is_real = num_txs > uint32_ct(&composer, i);
         auto& public_inputs = recursion_output.public_inputs;
@@ -347,8 +419,15 @@ recursion_output<bn254> rollup_circuit(Composer& composer,
             public_inputs[j] *= is_real;
         }
 
-        auto tx_fee = process_defi_deposit(
-            composer, rollup_id, public_inputs, bridge_call_datas, defi_deposit_sums, num_defi_interactions);
+        auto tx_fee = process_defi_deposit(composer,
+                                           rollup_id,
+                                           public_inputs,
+                                           bridge_call_datas,
+                                           defi_deposit_sums,
+                                           num_defi_interactions,
+                                           select_matches,
+                                           selectable_bridge_call_datas,
+                                           bridge_call_data_uses);
 
         process_claims(public_inputs, new_defi_root);
 
@@ -356,13 +435,16 @@ recursion_output<bn254> rollup_circuit(Composer& composer,
         // `process_defi_deposit()` & `process_claims()` functions, but before `process_chained_txs`.
         propagated_tx_public_inputs.push_back(slice(public_inputs, 0, PropagatedInnerProofFields::NUM_FIELDS));
 
-        process_chained_txs(i,
-                            is_real,
-                            public_inputs,
-                            prev_txs_public_inputs,
-                            old_data_root,
-                            linked_commitment_paths,
-                            linked_commitment_indices);
+        {
+            gate_profiler::Scope profile(composer, "process_chained_txs");
+            process_chained_txs(i,
+                                is_real,
+                                public_inputs,
+                                prev_txs_public_inputs,
+                                old_data_root,
+                                linked_commitment_paths,
+                                linked_commitment_indices);
+        }
 
         // Add this proof's data values to the list.
         new_data_values.push_back(public_inputs[InnerProofFields::NOTE_COMMITMENT1]);
@@ -373,24 +455,46 @@ recursion_output<bn254> rollup_circuit(Composer& composer,
         new_null_indicies.push_back(public_inputs[InnerProofFields::NULLIFIER2]);
 
         // Check this proof's data root exists in the data root tree (unless a padding entry).
-        auto data_root = public_inputs[InnerProofFields::MERKLE_ROOT];
-        bool_ct data_root_exists =
-            data_root != 0 && check_membership(data_roots_root,
-                                               data_roots_paths[i],
-                                               data_root,
-                                               data_root_indicies[i].decompose_into_bits(ROOT_TREE_DEPTH));
-        is_real.assert_equal(data_root_exists, format("data_root_for_proof_", i));
+        {
+            gate_profiler::Scope profile(composer, "check_data_root");
+            auto data_root = public_inputs[InnerProofFields::MERKLE_ROOT];
+            bool_ct data_root_exists =
+                data_root != 0 && check_membership(data_roots_root,
+                                                   data_roots_paths[i],
+                                                   data_root,
+                                                   data_root_indicies[i].decompose_into_bits(ROOT_TREE_DEPTH));
+            is_real.assert_equal(data_root_exists, format("data_root_for_proof_", i));
+        }
 
         // Accumulate tx fee.
         auto proof_id = public_inputs[InnerProofFields::PROOF_ID];
         auto asset_id = public_inputs[InnerProofFields::TX_FEE_ASSET_ID];
-        accumulate_tx_fees(composer, total_tx_fees, proof_id, asset_id, tx_fee, asset_ids, num_asset_ids, is_real);
+        accumulate_tx_fees(composer,
+                           total_tx_fees,
+                           proof_id,
+                           asset_id,
+                           tx_fee,
+                           asset_ids,
+                           num_asset_ids,
+                           is_real,
+                           select_matches,
+                           asset_id_uses);
 
         prev_txs_public_inputs.push_back(public_inputs);
     }
 
+    if (select_matches) {
+        // Each selected asset id and bridge call data must have been the only match. Unused entries may repeat.
+        assert_selected_entries_unique(asset_ids, asset_id_uses, "duplicate asset id");
+        assert_selected_entries_unique(
+            selectable_bridge_call_datas, bridge_call_data_uses, "duplicate bridge call data");
+    }
+
     new_data_values.resize(rollup_size_pow2_ * 2, fr(0));
-    batch_update_membership(new_data_root, old_data_root, old_data_path, new_data_values, data_start_index.value);
+    {
+        gate_profiler::Scope profile(composer, "batch_update_membership");
+        batch_update_membership(new_data_root, old_data_root, old_data_path, new_data_values, data_start_index.value);
+    }
 
     auto new_null_root =
         check_nullifiers_inserted(composer, new_null_roots, old_null_paths, num_txs, old_null_root, new_null_indicies);
@@ -398,7 +502,11 @@ recursion_output<bn254> rollup_circuit(Composer& composer,
     // Compute hash of the tx public inputs. Used to reduce number of public inputs published in root rollup.
     auto sha_input = flatten(propagated_tx_public_inputs);
     sha_input.resize(rollup_size_pow2_ * PropagatedInnerProofFields::NUM_FIELDS, field_ct(0));
-    auto hash_output = stdlib::sha256_to_field(packed_byte_array_ct::from_field_element_vector(sha_input));
+    field_ct hash_output;
+    {
+        gate_profiler::Scope profile(composer, "sha256_public_inputs");
+        hash_output = stdlib::sha256_to_field(packed_byte_array_ct::from_field_element_vector(sha_input));
+    }
 
     // Publish public inputs.
     rollup_id.set_public();
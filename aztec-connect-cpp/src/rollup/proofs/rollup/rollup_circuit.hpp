@@ -18,10 +18,16 @@ field_ct check_nullifiers_inserted(Composer& composer,
                                    field_ct latest_null_root,
                                    std::vector<field_ct> const& new_null_indicies);
 
+/**
+ * With `select_matches`, each tx's fee asset id and defi deposit bridge call data are matched against the rollup's by a
+ * prover selected index rather than compared with every entry. It accepts the same rollups, with fewer gates per tx,
+ * but is a different circuit, with its own keys.
+ */
 recursion_output<bn254> rollup_circuit(Composer& composer,
                                        rollup_tx const& proofs,
                                        std::vector<std::shared_ptr<waffle::verification_key>> const& verification_keys,
-                                       size_t rollup_size);
+                                       size_t rollup_size,
+                                       bool select_matches = false);
 
 } // namespace rollup
 } // namespace proofs
@@ -182,6 +182,21 @@ class rollup_tests : public ::testing::Test {
 
     void test_chain_off_disallowed_note_fails(uint32_t allow_chain, size_t indicator);
 
+    static rollup::circuit_data selecting(rollup::circuit_data cd)
+    {
+        cd.select_matches = true;
+        return cd;
+    }
+
+    // Builds the circuit without checking it, so a gate count can be taken from txs that don't fill the rollup.
+    static Composer build_rollup(rollup_tx tx, rollup::circuit_data const& cd, bool select_matches)
+    {
+        pad_rollup_tx(tx, cd.num_txs, cd.join_split_circuit_data.padding_proof);
+        Composer composer = Composer(cd.proving_key, cd.verification_key, cd.num_gates);
+        rollup_circuit(composer, tx, cd.verification_keys, cd.num_txs, select_matches);
+        return composer;
+    }
+
     fixtures::TestContext context;
     const uint32_t virtual_asset_id_flag = (uint32_t(1) << (MAX_NUM_ASSETS_BIT_LENGTH - 1));
 };
@@ -257,6 +272,26 @@ TEST_F(rollup_tests, test_1_proof_with_old_root_in_1_rollup)
     EXPECT_TRUE(result.logic_verified);
 }
 
+TEST_F(rollup_tests, test_1_proof_with_old_root_looks_up_root_index)
+{
+    size_t rollup_size = 1;
+
+    context.append_account_notes();
+    context.append_value_notes({ 100, 50 });
+    context.start_next_root_rollup();
+    auto join_split_proof = context.create_join_split_proof({ 2, 3 }, { 100, 50 }, { 70, 80 });
+    context.append_value_notes({ 30, 40 });
+    context.start_next_root_rollup();
+
+    // The data root index isn't given, so is found from the proof's data root.
+    auto rollup = create_rollup_tx(context.world_state, rollup_size, { join_split_proof });
+
+    EXPECT_EQ(rollup.data_roots_indicies[0], 1U);
+    auto result = verify_logic(rollup, rollup_1_keyless);
+
+    EXPECT_TRUE(result.logic_verified);
+}
+
 TEST_F(rollup_tests, test_1_proof_with_invalid_old_null_root_fails)
 {
     size_t rollup_size = 1;
@@ -1027,6 +1062,86 @@ TEST_F(rollup_tests, test_defi_deposit_sums_accumulated)
     EXPECT_EQ(rollup_data.total_tx_fees[3], 0);  // padding
 }
 
+// Selected matching tests.
+TEST_F(rollup_tests, test_select_matches_same_public_inputs)
+{
+    auto tx = create_tx_with_3_defi();
+    auto scan_tx = tx;
+    auto scanned = verify_logic(scan_tx, rollup_4_keyless);
+    auto result = verify_logic(tx, selecting(rollup_4_keyless));
+    ASSERT_TRUE(scanned.logic_verified);
+    ASSERT_TRUE(result.logic_verified) << result.err;
+
+    EXPECT_EQ(result.public_inputs, scanned.public_inputs);
+}
+
+TEST_F(rollup_tests, test_select_matches_proof_asset_id_not_in_assets)
+{
+    auto tx = create_tx_with_3_defi_include_non_fee_asset();
+    auto result = verify_logic(tx, selecting(rollup_4_keyless));
+    ASSERT_TRUE(result.logic_verified) << result.err;
+}
+
+TEST_F(rollup_tests, test_select_matches_asset_id_repeated_fails)
+{
+    auto tx = create_tx_with_3_defi();
+    tx.asset_ids.push_back(tx.asset_ids[0]);
+    auto result = verify_logic(tx, selecting(rollup_4_keyless));
+
+    ASSERT_FALSE(result.logic_verified);
+    EXPECT_EQ(result.err, "duplicate asset id at 0 and 3");
+}
+
+TEST_F(rollup_tests, test_select_matches_bridge_call_data_repeated_fails)
+{
+    auto tx = create_tx_with_1_defi();
+    tx.bridge_call_datas.push_back(tx.bridge_call_datas[0]);
+    auto result = verify_logic(tx, selecting(rollup_1_keyless));
+
+    ASSERT_FALSE(result.logic_verified);
+    EXPECT_EQ(result.err, "duplicate bridge call data at 0 and 1");
+}
+
+TEST_F(rollup_tests, test_select_matches_bridge_call_data_unmatched_fails)
+{
+    auto tx = create_tx_with_1_defi();
+    tx.bridge_call_datas[0] = { 1, 2, 0, 0 };
+    auto result = verify_logic(tx, selecting(rollup_1_keyless));
+
+    ASSERT_FALSE(result.logic_verified);
+    EXPECT_EQ(result.err, "proof bridge call data did not match a single bridge call data");
+}
+
+TEST_F(rollup_tests, test_select_matches_gate_count)
+{
+    auto tx = create_tx_with_3_defi();
+
+    // The per tx cost is the difference between 4 and 3 txs, which share a power of 2 layout. The rest is fixed.
+    auto txs_per_pow2 = [&](bool select_matches) {
+        auto gates3 = build_rollup(tx, rollup_3_keyless, select_matches).get_num_gates();
+        auto gates4 = build_rollup(tx, rollup_4_keyless, select_matches).get_num_gates();
+        auto per_tx = gates4 - gates3;
+        auto fixed = gates4 - 4 * per_tx;
+        auto capacity = (circuit_gate_next_power_of_two::ROLLUP - fixed) / per_tx;
+        info(select_matches ? "selected" : "compared",
+             " matching: ",
+             per_tx,
+             " gates per tx, ",
+             fixed,
+             " fixed, ",
+             capacity,
+             " txs per ",
+             circuit_gate_next_power_of_two::ROLLUP,
+             " gates.");
+        return std::make_pair(per_tx, capacity);
+    };
+
+    auto compared = txs_per_pow2(false);
+    auto selected = txs_per_pow2(true);
+    EXPECT_LT(selected.first, compared.first);
+    EXPECT_GE(selected.second, compared.second);
+}
+
 TEST_F(rollup_tests, test_defi_interaction_nonce_added_to_claim_notes)
 {
     auto tx = create_tx_with_3_defi();
@@ -24,7 +24,7 @@ verify_result<Composer> build_circuit(Composer& composer, rollup_tx& tx, circuit
 
     pad_rollup_tx(tx, cd.num_txs, cd.join_split_circuit_data.padding_proof);
 
-    result.recursion_output = rollup_circuit(composer, tx, cd.verification_keys, cd.num_txs);
+    result.recursion_output = rollup_circuit(composer, tx, cd.verification_keys, cd.num_txs, cd.select_matches);
     return result;
 }
 } // namespace
@@ -41,6 +41,19 @@ verify_result<Composer> verify(rollup_tx& tx, circuit_data const& cd)
     return verify_internal(composer, tx, cd, "tx rollup", true, build_circuit);
 }
 
+verify_result<Composer> verify_logic(Composer& composer, rollup_tx& tx, circuit_data const& cd)
+{
+    return verify_logic_internal(composer, tx, cd, "tx rollup", build_circuit);
+}
+
+verify_result<Composer> prove(Composer& composer, verify_result<Composer> result, circuit_data const& cd)
+{
+    if (!result.logic_verified) {
+        return result;
+    }
+    return prove_internal(composer, std::move(result), cd, "tx rollup", true);
+}
+
 } // namespace rollup
 } // namespace proofs
 } // namespace rollup
@@ -12,6 +12,17 @@ verify_result<Composer> verify_logic(rollup_tx& tx, circuit_data const& cd);
 
 verify_result<Composer> verify(rollup_tx& tx, circuit_data const& cd);
 
+/**
+ * Builds the circuit into `composer`, which must be constructed from `cd`'s keys, without proving it. Safe to call on
+ * another thread while a circuit built with the same keys is being proven, the two together being `verify`.
+ */
+verify_result<Composer> verify_logic(Composer& composer, rollup_tx& tx, circuit_data const& cd);
+
+/**
+ * Proves and verifies a circuit built by `verify_logic`, which returned `result`.
+ */
+verify_result<Composer> prove(Composer& composer, verify_result<Composer> result, circuit_data const& cd);
+
 } // namespace rollup
 } // namespace proofs
 } // namespace rollup
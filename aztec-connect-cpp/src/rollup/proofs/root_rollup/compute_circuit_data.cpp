@@ -27,7 +27,10 @@ circuit_data get_circuit_data(size_t num_inner_rollups,
     auto floor = 1UL << numeric::get_msb(rollup_size);
     auto rollup_size_pow2 = rollup_size == floor ? rollup_size : floor << 1UL;
     std::cerr << "Getting root rollup circuit data: (size: " << rollup_size_pow2 << ")" << std::endl;
-    auto name = format("root_rollup_", rollup_circuit_data.num_txs, "x", num_inner_rollups);
+    // A root rollup over tx rollups that select their matches selects its own, and so has its own keys.
+    auto select_matches = rollup_circuit_data.select_matches;
+    auto name =
+        format("root_rollup_", rollup_circuit_data.num_txs, "x", num_inner_rollups, select_matches ? "_selected" : "");
 
     auto build_circuit = [&](Composer& composer) {
         auto gibberish_roots_path =
@@ -52,7 +55,8 @@ circuit_data get_circuit_data(size_t num_inner_rollups,
                             root_rollup,
                             rollup_circuit_data.rollup_size,
                             rollup_size_pow2,
-                            rollup_circuit_data.verification_key);
+                            rollup_circuit_data.verification_key,
+                            select_matches);
     };
 
     auto cd = proofs::get_circuit_data<Composer>("root rollup",
@@ -44,7 +44,7 @@ inline root_rollup_tx create_root_rollup_tx(WorldState& world_state,
     tx.old_data_roots_root = root_tree.root();
     tx.old_data_roots_path = root_tree.get_hash_path(root_index);
     auto data_root = data_tree.root();
-    root_tree.update_element(root_index, data_root);
+    world_state.insert_root_entry(root_index, data_root);
     tx.new_data_roots_root = root_tree.root();
 
     tx.old_defi_root = old_defi_root;
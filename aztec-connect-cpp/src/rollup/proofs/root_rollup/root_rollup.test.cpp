@@ -186,6 +186,24 @@ class root_rollup_tests : public ::testing::Test {
             interaction_notes);
     }
 
+    // Builds the root rollup circuit over tx padded to num_inner_rollups inner rollups, as verify_logic does.
+    static Composer build_root_rollup(root_rollup_tx tx, size_t num_inner_rollups, bool select_matches)
+    {
+        auto cd = root_rollup_cd;
+        cd.num_inner_rollups = num_inner_rollups;
+        cd.rollup_size = num_inner_rollups * INNER_ROLLUP_TXS;
+        pad_root_rollup_tx(tx, cd);
+
+        Composer composer(srs);
+        root_rollup_circuit(composer,
+                            tx,
+                            cd.inner_rollup_circuit_data.rollup_size,
+                            cd.rollup_size,
+                            cd.inner_rollup_circuit_data.verification_key,
+                            select_matches);
+        return composer;
+    }
+
     fixtures::TestContext context;
     std::vector<std::vector<uint8_t>> js_proofs;
 };
@@ -340,6 +358,70 @@ TEST_F(root_rollup_tests, test_bridge_call_datas_reordering)
     ASSERT_TRUE(result.logic_verified);
 }
 
+TEST_F(root_rollup_tests, test_duplicate_used_bridge_call_data_fails)
+{
+    auto tx_data = create_full_logic_root_rollup_tx();
+    tx_data.bridge_call_datas[2] = tx_data.bridge_call_datas[0]; // bridge_call_datas = [bid2, bid3, bid2, 0]
+
+    auto result = verify_logic(tx_data, root_rollup_cd);
+    ASSERT_FALSE(result.logic_verified);
+
+    auto composer = build_root_rollup(tx_data, ROLLUPS_PER_ROLLUP, true);
+    ASSERT_TRUE(composer.failed);
+    EXPECT_EQ(composer.err, "duplicate bridge call data at 0 and 2");
+}
+
+TEST_F(root_rollup_tests, test_duplicate_unused_bridge_call_datas)
+{
+    auto tx_data = create_full_logic_root_rollup_tx();
+    tx_data.bridge_call_datas[2] = 0xdeadbeef;
+    tx_data.bridge_call_datas[3] = 0xdeadbeef; // bridge_call_datas = [bid2, bid3, x, x]
+
+    auto result = verify_logic(tx_data, root_rollup_cd);
+    ASSERT_TRUE(result.logic_verified);
+
+    auto composer = build_root_rollup(tx_data, ROLLUPS_PER_ROLLUP, true);
+    EXPECT_FALSE(composer.failed) << composer.err;
+}
+
+TEST_F(root_rollup_tests, test_select_matches_full_logic)
+{
+    auto tx_data = create_full_logic_root_rollup_tx();
+
+    auto composer = build_root_rollup(tx_data, ROLLUPS_PER_ROLLUP, true);
+    EXPECT_FALSE(composer.failed) << composer.err;
+}
+
+TEST_F(root_rollup_tests, test_select_matches_gate_count)
+{
+    auto tx_data = create_full_logic_root_rollup_tx();
+
+    // The per inner rollup cost is the difference between 3 and 2 inner rollups, the rest is fixed.
+    auto inner_rollups_per_pow2 = [&](bool select_matches) {
+        auto gates2 = build_root_rollup(tx_data, 2, select_matches).get_num_gates();
+        auto gates3 = build_root_rollup(tx_data, 3, select_matches).get_num_gates();
+        auto per_inner = gates3 - gates2;
+        auto fixed = gates3 - 3 * per_inner;
+        auto capacity = (circuit_gate_next_power_of_two::ROOT_ROLLUP - fixed) / per_inner;
+        info(select_matches ? "selected" : "compared",
+             " matching: ",
+             per_inner,
+             " gates per inner rollup, ",
+             fixed,
+             " fixed, ",
+             capacity,
+             " inner rollups per ",
+             circuit_gate_next_power_of_two::ROOT_ROLLUP,
+             " gates.");
+        return std::make_pair(per_inner, capacity);
+    };
+
+    auto compared = inner_rollups_per_pow2(false);
+    auto selected = inner_rollups_per_pow2(true);
+    EXPECT_LT(selected.first, compared.first);
+    EXPECT_GE(selected.second, compared.second);
+}
+
 // Full logic tests
 TEST_F(root_rollup_tests, test_full_logic)
 {
@@ -4,11 +4,14 @@
 #include "../notes/constants.hpp"
 #include "../notes/circuit/index.hpp"
 #include "root_rollup_circuit.hpp"
+#include "../one_hot_select.hpp"
+#include "../gate_profiler/gate_profiler.hpp"
 #include <stdlib/merkle_tree/index.hpp>
 #include <stdlib/hash/sha256/sha256.hpp>
 #include <common/map.hpp>
 #include <common/container.hpp>
 #include "./root_rollup_proof_data.hpp"
+#include "../../trace/trace.hpp"
 
 // #pragma GCC diagnostic ignored "-Wunused-variable"
 // #pragma GCC diagnostic ignored "-Wunused-parameter"
@@ -60,6 +63,7 @@ field_ct process_defi_interaction_notes(Composer& composer,
                                         std::vector<circuit::defi_interaction::note> const& defi_interaction_notes,
                                         std::vector<field_ct>& defi_interaction_note_commitments)
 {
+    gate_profiler::Scope profile(composer, "process_defi_interaction_notes");
     std::vector<field_ct> hash_input;
 
     for (uint32_t i = 0; i < NUM_INTERACTION_RESULTS_PER_BLOCK; i++) {
@@ -95,21 +99,46 @@ field_ct process_defi_interaction_notes(Composer& composer,
     return field_ct(hash_output);
 }
 
+/**
+ * Checks each of the inner rollup's asset ids matches exactly one of this rollup's asset ids, and accumulates its fee.
+ *
+ * With `select_matches`, the prover selects the matching entry rather than it being compared with every entry, which
+ * is cheaper. `asset_id_uses` counts the selections of each entry, for `assert_selected_entries_unique` to check the
+ * selected entry was the only match once all inner rollups are processed.
+ */
 void check_asset_ids_and_accumulate_tx_fees(Composer& composer,
                                             uint32_t const i,
                                             std::vector<field_ct>& total_tx_fees,
                                             std::vector<field_ct> const& asset_ids,
                                             std::vector<field_ct> const& public_inputs,
-                                            bool_ct const& is_real)
+                                            bool_ct const& is_real,
+                                            bool select_matches,
+                                            std::vector<field_ct>& asset_id_uses)
 {
     // Check every real tx rollup proof has correct asset ids.
     for (size_t j = 0; j < NUM_ASSETS; j++) {
-
-        field_ct num_matched(&composer, 0);
         auto inner_asset_id = public_inputs[rollup::RollupProofFields::ASSET_IDS + j];
         auto inner_tx_fee = public_inputs[rollup::RollupProofFields::TOTAL_TX_FEES + j];
         auto is_asset_id_padded = (inner_asset_id == field_ct(MAX_NUM_ASSETS));
 
+        if (select_matches) {
+            auto matches = one_hot_select(composer,
+                                          inner_asset_id,
+                                          asset_ids,
+                                          is_real && !is_asset_id_padded,
+                                          format("rollup proof ",
+                                                 i,
+                                                 "'s asset id ",
+                                                 uint64_t(inner_asset_id.get_value()),
+                                                 " did not match a single asset id."));
+            for (uint32_t k = 0; k < NUM_ASSETS; k++) {
+                total_tx_fees[k] += inner_tx_fee * field_ct(matches[k]);
+                asset_id_uses[k] += field_ct(matches[k]);
+            }
+            continue;
+        }
+
+        field_ct num_matched(&composer, 0);
         for (uint32_t k = 0; k < NUM_ASSETS; k++) {
             const auto matches = (inner_asset_id == asset_ids[k]);
             num_matched += matches;
@@ -131,21 +160,43 @@ void check_asset_ids_and_accumulate_tx_fees(Composer& composer,
     }
 }
 
+/**
+ * Checks each of the inner rollup's bridge call datas matches exactly one of this rollup's bridge call datas, and
+ * accumulates its deposits. `select_matches` and `bridge_call_data_uses` are as for asset ids.
+ */
 void check_bridge_call_datas_and_accumulate_defi_deposits(Composer& composer,
                                                           uint32_t const i,
                                                           std::vector<field_ct>& defi_deposit_sums,
                                                           std::vector<field_ct> const& bridge_call_datas,
                                                           std::vector<field_ct> const& public_inputs,
-                                                          bool_ct const& is_real)
+                                                          bool_ct const& is_real,
+                                                          bool select_matches,
+                                                          std::vector<field_ct>& bridge_call_data_uses)
 {
     // Check every real tx rollup proof has correct bridge call data.
     for (size_t j = 0; j < NUM_BRIDGE_CALLS_PER_BLOCK; j++) {
-
-        field_ct num_matched(&composer, 0);
         auto inner_bridge_call_data = public_inputs[rollup::RollupProofFields::DEFI_BRIDGE_CALL_DATAS + j];
         auto inner_defi_deposit_sum = public_inputs[rollup::RollupProofFields::DEFI_BRIDGE_DEPOSITS + j];
         auto is_bridge_call_data_zero = inner_bridge_call_data.is_zero();
 
+        if (select_matches) {
+            auto matches = one_hot_select(composer,
+                                          inner_bridge_call_data,
+                                          bridge_call_datas,
+                                          is_real && !is_bridge_call_data_zero,
+                                          format("rollup proof ",
+                                                 i,
+                                                 "'s bridge call data at index ",
+                                                 j,
+                                                 " did not match a single bridge call data."));
+            for (uint32_t k = 0; k < NUM_BRIDGE_CALLS_PER_BLOCK; k++) {
+                defi_deposit_sums[k] += inner_defi_deposit_sum * field_ct(matches[k]);
+                bridge_call_data_uses[k] += field_ct(matches[k]);
+            }
+            continue;
+        }
+
+        field_ct num_matched(&composer, 0);
         for (uint32_t k = 0; k < NUM_BRIDGE_CALLS_PER_BLOCK; k++) {
             const auto matches = (inner_bridge_call_data == bridge_call_datas[k]);
             num_matched += matches;
@@ -228,8 +279,11 @@ circuit_result_data root_rollup_circuit(Composer& composer,
                                         root_rollup_tx const& tx,
                                         size_t num_inner_txs_pow2,
                                         size_t num_outer_txs_pow2,
-                                        std::shared_ptr<waffle::verification_key> const& inner_verification_key)
+                                        std::shared_ptr<waffle::verification_key> const& inner_verification_key,
+                                        bool select_matches)
 {
+    gate_profiler::Scope profile(composer, "root_rollup_circuit");
+
     auto max_num_inner_proofs = tx.rollups.size();
     ASSERT(max_num_inner_proofs <= num_outer_txs_pow2);
 
@@ -274,17 +328,20 @@ circuit_result_data root_rollup_circuit(Composer& composer,
     std::vector<field_ct> total_tx_fees(NUM_ASSETS, field_ct(witness_ct::create_constant_witness(&composer, 0)));
     std::vector<field_ct> defi_deposit_sums(NUM_BRIDGE_CALLS_PER_BLOCK,
                                             field_ct(witness_ct::create_constant_witness(&composer, 0)));
+    std::vector<field_ct> asset_id_uses(NUM_ASSETS, field_ct(&composer, 0));
+    std::vector<field_ct> bridge_call_data_uses(NUM_BRIDGE_CALLS_PER_BLOCK, field_ct(&composer, 0));
 
     // Loop over each inner proof.
     for (uint32_t i = 0; i < max_num_inner_proofs; ++i) {
         auto is_real = num_inner_proofs > i;
 
-        recursion_output =
-            verify_proof<bn254, recursive_turbo_verifier_settings<bn254>>(&composer,
-                                                                          recursive_verification_key,
-                                                                          recursive_manifest,
-                                                                          waffle::plonk_proof{ tx.rollups[i] },
-                                                                          recursion_output);
+        {
+            trace::Span span("verify inner rollup proof", "circuit", "inner rollup", i);
+            gate_profiler::Scope profile(composer, "verify_proof");
+            recursion_output = verify_proof<bn254, recursive_turbo_verifier_settings<bn254>>(
+                &composer, recursive_verification_key, recursive_manifest, waffle::plonk_proof{ tx.rollups[i] },
+                recursion_output);
+        }
 
         auto& public_inputs = recursion_output.public_inputs;
 
@@ -294,11 +351,18 @@ circuit_result_data root_rollup_circuit(Composer& composer,
         }
 
         // Accumulate tx fees.
-        check_asset_ids_and_accumulate_tx_fees(composer, i, total_tx_fees, asset_ids, public_inputs, is_real);
+        check_asset_ids_and_accumulate_tx_fees(
+            composer, i, total_tx_fees, asset_ids, public_inputs, is_real, select_matches, asset_id_uses);
 
         // Accumulate defi deposits.
-        check_bridge_call_datas_and_accumulate_defi_deposits(
-            composer, i, defi_deposit_sums, bridge_call_datas, public_inputs, is_real);
+        check_bridge_call_datas_and_accumulate_defi_deposits(composer,
+                                                             i,
+                                                             defi_deposit_sums,
+                                                             bridge_call_datas,
+                                                             public_inputs,
+                                                             is_real,
+                                                             select_matches,
+                                                             bridge_call_data_uses);
 
         assert_inner_proof_sequential(num_inner_txs_pow2,
                                       i,
@@ -324,8 +388,15 @@ circuit_result_data root_rollup_circuit(Composer& composer,
         }
     }
 
+    if (select_matches) {
+        // Each selected asset id and bridge call data must have been the only match. Unused entries may repeat.
+        assert_selected_entries_unique(asset_ids, asset_id_uses, "duplicate asset id");
+        assert_selected_entries_unique(bridge_call_datas, bridge_call_data_uses, "duplicate bridge call data");
+    }
+
     // Check defi interaction notes are inserted and computes previous_defi_interaction_hash.
     std::vector<field_ct> defi_interaction_note_commitments;
+    trace::Span defi_span("process defi interaction notes", "circuit");
     auto previous_defi_interaction_hash = process_defi_interaction_notes(composer,
                                                                          rollup_id,
                                                                          new_defi_root,
@@ -334,9 +405,13 @@ circuit_result_data root_rollup_circuit(Composer& composer,
                                                                          num_previous_defi_interactions,
                                                                          defi_interaction_notes,
                                                                          defi_interaction_note_commitments);
+    defi_span.stop();
 
     // Check data root tree is updated with latest data root.
-    check_root_tree_updated(old_root_path, rollup_id, new_data_root, new_root_root, old_root_root);
+    {
+        gate_profiler::Scope profile(composer, "check_root_tree_updated");
+        check_root_tree_updated(old_root_path, rollup_id, new_data_root, new_root_root, old_root_root);
+    }
 
     // Construct a list of header fields.
     auto num_inner_proofs_pow2 = num_outer_txs_pow2 / num_inner_txs_pow2;
@@ -358,7 +433,11 @@ circuit_result_data root_rollup_circuit(Composer& composer,
     // [ header fields ][ hashes of each inner rollups inputs ][ zero_hash padding ]
     auto zero_hashes = std::vector<field_ct>(num_inner_proofs_pow2 - max_num_inner_proofs, zero_hash);
     auto inputs_to_hash = join({ header_fields, inner_input_hashes, zero_hashes });
-    auto input_hash = stdlib::sha256_to_field(packed_byte_array_ct::from_field_element_vector(inputs_to_hash));
+    field_ct input_hash;
+    {
+        gate_profiler::Scope profile(composer, "sha256_public_inputs");
+        input_hash = stdlib::sha256_to_field(packed_byte_array_ct::from_field_element_vector(inputs_to_hash));
+    }
 
     // Construct list of fields to be broadcast along with proof.
     // [ header fields ][ public inputs of each tx ][ zero field padding ]
@@ -16,11 +16,18 @@ struct circuit_result_data {
     std::vector<fr> broadcast_data;
 };
 
+/**
+ * With `select_matches`, inner rollups' asset ids and bridge call datas are matched against the root rollup's by a
+ * prover selected entry rather than by comparison with every entry. It accepts the same root rollups in fewer gates,
+ * but changes the verification key, so is only used over tx rollups built with it too (see
+ * `rollup::circuit_data::select_matches`).
+ */
 circuit_result_data root_rollup_circuit(Composer& composer,
                                         root_rollup_tx const& rollups,
                                         size_t inner_rollup_size,
                                         size_t outer_rollup_size,
-                                        std::shared_ptr<waffle::verification_key> const& inner_verification_key);
+                                        std::shared_ptr<waffle::verification_key> const& inner_verification_key,
+                                        bool select_matches = false);
 
 } // namespace root_rollup
 } // namespace proofs
@@ -31,7 +31,8 @@ verify_result build_circuit(Composer& composer, root_rollup_tx& tx, circuit_data
                                               tx,
                                               circuit_data.inner_rollup_circuit_data.rollup_size,
                                               circuit_data.rollup_size,
-                                              circuit_data.inner_rollup_circuit_data.verification_key);
+                                              circuit_data.inner_rollup_circuit_data.verification_key,
+                                              circuit_data.inner_rollup_circuit_data.select_matches);
 
     result.recursion_output = circuit_result.recursion_output;
     result.broadcast_data = circuit_result.broadcast_data;
@@ -1,4 +1,6 @@
 #include "./root_verifier_circuit.hpp"
+#include "../../trace/trace.hpp"
+#include "../gate_profiler/gate_profiler.hpp"
 
 namespace rollup {
 namespace proofs {
@@ -13,6 +15,7 @@ recursion_output<outer_curve> root_verifier_circuit(
     std::shared_ptr<waffle::verification_key> const& inner_verification_key,
     std::vector<std::shared_ptr<waffle::verification_key>> const& valid_vks)
 {
+    gate_profiler::Scope profile(composer, "root_verifier_circuit");
     recursion_output<outer_curve> recursion_output;
     if (!valid_vks.size()) {
         composer.failed = true;
@@ -23,11 +26,15 @@ recursion_output<outer_curve> root_verifier_circuit(
     auto recursive_manifest = InnerComposer::create_unrolled_manifest(inner_verification_key->num_public_inputs);
     auto recursive_verification_key = verification_key_pt::from_witness(&composer, inner_verification_key);
     recursive_verification_key->validate_key_is_in_set(valid_vks);
-    recursion_output = verify_proof<outer_curve, recursive_settings>(&composer,
-                                                                     recursive_verification_key,
-                                                                     recursive_manifest,
-                                                                     waffle::plonk_proof{ tx.proof_data },
-                                                                     recursion_output);
+    {
+        trace::Span span("verify root rollup proof", "circuit");
+        gate_profiler::Scope profile(composer, "verify_proof");
+        recursion_output = verify_proof<outer_curve, recursive_settings>(&composer,
+                                                                         recursive_verification_key,
+                                                                         recursive_manifest,
+                                                                         waffle::plonk_proof{ tx.proof_data },
+                                                                         recursion_output);
+    }
 
     // Expose the broadcast data hash, and recursion point inputs.
     recursion_output.public_inputs[0].set_public();
@@ -1,5 +1,7 @@
 #pragma once
 #include "./mock/mock_circuit.hpp"
+#include "../metrics/metrics.hpp"
+#include "../trace/trace.hpp"
 #include <ecc/curves/bn254/fq12.hpp>
 #include <ecc/curves/bn254/pairing.hpp>
 #include <stdlib/recursion/verifier/verifier.hpp>
@@ -41,13 +43,21 @@ inline bool pairing_check(plonk::stdlib::recursion::recursion_output<plonk::stdl
 template <typename Composer, typename Tx, typename CircuitData, typename F>
 auto verify_logic_internal(Composer& composer, Tx& tx, CircuitData const& cd, char const* name, F const& build_circuit)
 {
+    auto& metrics = metrics::registry();
+    auto circuit = metrics::label("circuit", name);
+
     info(name, ": Building circuit...");
     Timer timer;
+    metrics::ScopedTimer build_timer("rollup_circuit_build_seconds", circuit);
+    trace::Span build_span("build circuit", "circuit", name);
     auto result = build_circuit(composer, tx, cd);
+    build_span.stop();
+    build_timer.stop();
     info(name, ": Circuit built in ", timer.toString(), "s");
 
     if (composer.failed) {
         info(name, ": Circuit logic failed: " + composer.err);
+        metrics.increment("rollup_proof_failures_total", circuit + ",reason=\"logic\"");
         result.err = composer.err;
         return result;
     }
@@ -57,8 +67,14 @@ auto verify_logic_internal(Composer& composer, Tx& tx, CircuitData const& cd, ch
         return result;
     }
 
-    if (!pairing_check(result.recursion_output, cd.srs->get_verifier_crs())) {
+    metrics::ScopedTimer pairing_timer("rollup_pairing_check_seconds", circuit);
+    trace::Span pairing_span("pairing check", "verifier", name);
+    auto pairing_verified = pairing_check(result.recursion_output, cd.srs->get_verifier_crs());
+    pairing_span.stop();
+    pairing_timer.stop();
+    if (!pairing_verified) {
         info(name, ": Native pairing check failed.");
+        metrics.increment("rollup_proof_failures_total", circuit + ",reason=\"pairing\"");
         return result;
     }
 
@@ -69,19 +85,19 @@ auto verify_logic_internal(Composer& composer, Tx& tx, CircuitData const& cd, ch
     return result;
 }
 
-template <typename Composer, typename Tx, typename CircuitData, typename F>
-auto verify_internal(
-    Composer& composer, Tx& tx, CircuitData const& cd, char const* name, bool unrolled, F const& build_circuit)
+/**
+ * Proves and verifies a circuit that's been built into `composer`, and has passed `verify_logic_internal`, which
+ * returned `result`. The two are separate so a circuit can be built while another is being proven: building only
+ * touches its composer, whereas proving writes to the proving key.
+ */
+template <typename Composer, typename Result, typename CircuitData>
+Result prove_internal(Composer& composer, Result result, CircuitData const& cd, char const* name, bool unrolled)
 {
-    Timer timer;
-    auto result = verify_logic_internal(composer, tx, cd, name, build_circuit);
-
-    if (!result.logic_verified) {
-        return result;
-    }
-
+    auto circuit = metrics::label("circuit", name);
     Timer proof_timer;
     info(name, ": Creating proof...");
+    metrics::ScopedTimer construction_timer("rollup_proof_construction_seconds", circuit);
+    trace::Span construction_span("construct proof", "prover", name);
 
     if (!cd.mock) {
         if (unrolled) {
@@ -107,8 +123,11 @@ auto verify_internal(
         }
     }
 
+    construction_span.stop();
+    construction_timer.stop();
     info(name, ": Proof created in ", proof_timer.toString(), "s");
-    info(name, ": Total time taken: ", timer.toString(), "s");
+    metrics::ScopedTimer verification_timer("rollup_proof_verification_seconds", circuit);
+    trace::Span verification_span("verify proof", "verifier", name);
     if (unrolled) {
         auto verifier = composer.create_unrolled_verifier();
         result.verified = verifier.verify_proof({ result.proof_data });
@@ -116,9 +135,12 @@ auto verify_internal(
         auto verifier = composer.create_verifier();
         result.verified = verifier.verify_proof({ result.proof_data });
     }
+    verification_span.stop();
+    verification_timer.stop();
 
     if (!result.verified) {
         info(name, ": Proof validation failed.");
+        metrics::registry().increment("rollup_proof_failures_total", circuit + ",reason=\"verification\"");
         return result;
     } else {
         info(name, ": Verified successfully.");
@@ -127,5 +149,21 @@ auto verify_internal(
     return result;
 }
 
+template <typename Composer, typename Tx, typename CircuitData, typename F>
+auto verify_internal(
+    Composer& composer, Tx& tx, CircuitData const& cd, char const* name, bool unrolled, F const& build_circuit)
+{
+    Timer timer;
+    auto result = verify_logic_internal(composer, tx, cd, name, build_circuit);
+
+    if (!result.logic_verified) {
+        return result;
+    }
+
+    result = prove_internal(composer, std::move(result), cd, name, unrolled);
+    info(name, ": Total time taken: ", timer.toString(), "s");
+    return result;
+}
+
 } // namespace proofs
 } // namespace rollup
@@ -0,0 +1,92 @@
+#pragma once
+#include <crypto/sha256/sha256.hpp>
+#include <array>
+#include <list>
+#include <map>
+#include <vector>
+
+namespace rollup {
+namespace artifact_cache {
+
+using Hash = std::array<uint8_t, 32>;
+
+inline Hash hash(std::vector<uint8_t> const& artifact)
+{
+    Hash result = sha256::sha256(artifact);
+    return result;
+}
+
+/**
+ * The proofs rollup_cli most recently returned, by the sha256 of their bytes, so later requests can refer to them by
+ * hash rather than send them back. Holds at most `capacity` bytes of artifacts, evicting the least recently used.
+ */
+class ArtifactCache {
+  public:
+    explicit ArtifactCache(size_t capacity)
+        : capacity_(capacity)
+    {}
+
+    /**
+     * Caches the artifact, unless it alone is over capacity, and returns its hash.
+     */
+    Hash put(std::vector<uint8_t> const& artifact)
+    {
+        auto key = hash(artifact);
+        auto it = entries_.find(key);
+        if (it != entries_.end()) {
+            recency_.splice(recency_.begin(), recency_, it->second.recency);
+            return key;
+        }
+        if (artifact.size() > capacity_) {
+            return key;
+        }
+        while (size_ + artifact.size() > capacity_) {
+            evict();
+        }
+        recency_.push_front(key);
+        entries_[key] = { artifact, recency_.begin() };
+        size_ += artifact.size();
+        return key;
+    }
+
+    /**
+     * The artifact with the hash, or null if it isn't cached. Valid until the next `put`.
+     */
+    std::vector<uint8_t> const* get(Hash const& key)
+    {
+        auto it = entries_.find(key);
+        if (it == entries_.end()) {
+            return nullptr;
+        }
+        recency_.splice(recency_.begin(), recency_, it->second.recency);
+        return &it->second.artifact;
+    }
+
+    // Total bytes of the cached artifacts.
+    size_t size() const { return size_; }
+
+    size_t count() const { return entries_.size(); }
+
+  private:
+    struct Entry {
+        std::vector<uint8_t> artifact;
+        std::list<Hash>::iterator recency;
+    };
+
+    void evict()
+    {
+        auto it = entries_.find(recency_.back());
+        size_ -= it->second.artifact.size();
+        entries_.erase(it);
+        recency_.pop_back();
+    }
+
+    size_t capacity_;
+    size_t size_ = 0;
+    // Most recently used first.
+    std::list<Hash> recency_;
+    std::map<Hash, Entry> entries_;
+};
+
+} // namespace artifact_cache
+} // namespace rollup
@@ -0,0 +1,189 @@
+#pragma once
+#include <common/log.hpp>
+#include <common/serialize.hpp>
+#include <common/throw_or_abort.hpp>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+namespace rollup {
+namespace capture {
+
+// "RCAP", followed by the format version.
+constexpr uint32_t MAGIC = 0x52434150;
+constexpr uint32_t VERSION = 1;
+
+/**
+ * A request as rollup_cli read it from standard input, with how long it took to respond.
+ */
+struct Record {
+    uint32_t proof_id;
+    // Microseconds from the start of the capture to the request's arrival.
+    uint64_t arrival;
+    // Microseconds from the request's arrival to its response being written.
+    uint64_t duration;
+    bool success;
+    // The request's bytes after the proof id, exactly as read.
+    std::vector<uint8_t> body;
+};
+
+template <typename B> inline void read(B& it, Record& record)
+{
+    using serialize::read;
+    read(it, record.proof_id);
+    read(it, record.arrival);
+    read(it, record.duration);
+    read(it, record.success);
+    read(it, record.body);
+}
+
+template <typename B> inline void write(B& buf, Record const& record)
+{
+    using serialize::write;
+    write(buf, record.proof_id);
+    write(buf, record.arrival);
+    write(buf, record.duration);
+    write(buf, record.success);
+    write(buf, record.body);
+}
+
+/**
+ * A stream buffer over another that keeps a copy of everything read through it, until it's taken with `take`. Reads
+ * ahead only what the source has available, so never blocks for input a request doesn't need.
+ */
+class TeeBuffer : public std::streambuf {
+  public:
+    explicit TeeBuffer(std::streambuf* source)
+        : source_(source)
+        , buffer_(1 << 16)
+    {}
+
+    std::streambuf* source() const { return source_; }
+
+    /**
+     * Returns the bytes consumed since the last call.
+     */
+    std::vector<uint8_t> take()
+    {
+        auto unread = static_cast<size_t>(egptr() - gptr());
+        auto consumed = copied_.size() - unread;
+        std::vector<uint8_t> bytes(copied_.begin(), copied_.begin() + static_cast<std::ptrdiff_t>(consumed));
+        copied_.erase(copied_.begin(), copied_.begin() + static_cast<std::ptrdiff_t>(consumed));
+        return bytes;
+    }
+
+  protected:
+    int_type underflow() override
+    {
+        if (gptr() < egptr()) {
+            return traits_type::to_int_type(*gptr());
+        }
+        auto available = std::min(source_->in_avail(), static_cast<std::streamsize>(buffer_.size()));
+        std::streamsize count = 0;
+        if (available > 0) {
+            count = source_->sgetn(buffer_.data(), available);
+        } else {
+            // Nothing buffered, so wait for the next byte.
+            auto c = source_->sbumpc();
+            if (traits_type::eq_int_type(c, traits_type::eof())) {
+                return traits_type::eof();
+            }
+            buffer_[0] = traits_type::to_char_type(c);
+            count = 1;
+        }
+        copied_.insert(copied_.end(), buffer_.data(), buffer_.data() + count);
+        setg(buffer_.data(), buffer_.data(), buffer_.data() + count);
+        return traits_type::to_int_type(*gptr());
+    }
+
+  private:
+    std::streambuf* source_;
+    std::vector<char> buffer_;
+    // Bytes read from the source and not yet taken, including any read ahead into the buffer.
+    std::vector<uint8_t> copied_;
+};
+
+/**
+ * Records the requests rollup_cli reads from standard input to a capture file, for `rollup_replay`.
+ *
+ * Installs itself in front of std::cin on construction. The loop reading requests calls `begin` once it has read a
+ * request's proof id, and `end` once the response is written.
+ */
+class Recorder {
+  public:
+    explicit Recorder(std::string const& path)
+        : file_(path, std::ios::binary)
+        , tee_(std::cin.rdbuf())
+        , start_(std::chrono::steady_clock::now())
+    {
+        std::cin.rdbuf(&tee_);
+        serialize::write(file_, MAGIC);
+        serialize::write(file_, VERSION);
+    }
+
+    ~Recorder() { std::cin.rdbuf(tee_.source()); }
+
+    void begin(uint32_t proof_id)
+    {
+        record_.proof_id = proof_id;
+        request_start_ = std::chrono::steady_clock::now();
+        record_.arrival = microseconds(request_start_ - start_);
+        // Drop the proof id, already read.
+        tee_.take();
+    }
+
+    void end(bool success)
+    {
+        record_.duration = microseconds(std::chrono::steady_clock::now() - request_start_);
+        record_.success = success;
+        record_.body = tee_.take();
+        write(file_, record_);
+        // Flushed per request, so a capture is usable if rollup_cli is killed.
+        file_.flush();
+    }
+
+  private:
+    static uint64_t microseconds(std::chrono::steady_clock::duration duration)
+    {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(duration).count());
+    }
+
+    std::ofstream file_;
+    TeeBuffer tee_;
+    std::chrono::steady_clock::time_point start_;
+    std::chrono::steady_clock::time_point request_start_;
+    Record record_;
+};
+
+/**
+ * Reads a capture file's records, or throws if it isn't one.
+ */
+inline std::vector<Record> read_capture(std::string const& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    uint32_t magic = 0;
+    uint32_t version = 0;
+    serialize::read(file, magic);
+    serialize::read(file, version);
+    if (!file.good() || magic != MAGIC || version != VERSION) {
+        throw_or_abort(format("Not a version ", VERSION, " capture file: ", path));
+    }
+    std::vector<Record> records;
+    while (file.peek() != std::char_traits<char>::eof()) {
+        Record record;
+        read(file, record);
+        if (!file.good()) {
+            // A capture cut short by rollup_cli being killed mid write.
+            break;
+        }
+        records.push_back(std::move(record));
+    }
+    return records;
+}
+
+} // namespace capture
+} // namespace rollup
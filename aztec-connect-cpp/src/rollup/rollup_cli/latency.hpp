@@ -0,0 +1,47 @@
+#pragma once
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace rollup {
+namespace latency {
+
+/**
+ * The sample at or above the fraction `p` of the sorted samples.
+ */
+inline double percentile(std::vector<double> const& sorted, double p)
+{
+    auto index = static_cast<size_t>(p * static_cast<double>(sorted.size() - 1) + 0.5);
+    return sorted[std::min(index, sorted.size() - 1)];
+}
+
+inline void print_header(std::ostream& os)
+{
+    os << std::left << std::setw(16) << "request" << std::setw(10) << "run" << std::right << std::setw(8) << "count"
+       << std::setw(12) << "mean" << std::setw(12) << "p50" << std::setw(12) << "p90" << std::setw(12) << "p99"
+       << std::setw(12) << "max" << std::endl;
+}
+
+/**
+ * Prints the distribution of a request's latencies, in seconds, under the header printed by `print_header`.
+ */
+inline void print_row(std::ostream& os, std::string const& name, std::string const& run, std::vector<double> samples)
+{
+    if (samples.empty()) {
+        return;
+    }
+    std::sort(samples.begin(), samples.end());
+    double total = 0;
+    for (auto sample : samples) {
+        total += sample;
+    }
+    os << std::left << std::setw(16) << name << std::setw(10) << run << std::right << std::setw(8) << samples.size()
+       << std::fixed << std::setprecision(3) << std::setw(12) << total / static_cast<double>(samples.size())
+       << std::setw(12) << percentile(samples, 0.5) << std::setw(12) << percentile(samples, 0.9) << std::setw(12)
+       << percentile(samples, 0.99) << std::setw(12) << samples.back() << std::endl;
+}
+
+} // namespace latency
+} // namespace rollup
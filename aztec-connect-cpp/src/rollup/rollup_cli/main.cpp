@@ -1,5 +1,11 @@
 #include <sstream>
+#include <atomic>
+#include <filesystem>
+#include <future>
 #include <iostream>
+#include <map>
+#include <mutex>
+#include <optional>
 
 #include <stdio.h>
 #include <sys/types.h>
@@ -10,12 +16,22 @@
 #include "../proofs/join_split/compute_circuit_data.hpp"
 #include "../proofs/claim/get_circuit_data.hpp"
 #include "../proofs/claim/verify.hpp"
+#include "../proofs/proof_pool.hpp"
 #include "../proofs/rollup/index.hpp"
 #include "../proofs/root_rollup/index.hpp"
 #include "../proofs/root_verifier/index.hpp"
+#include "../metrics/metrics.hpp"
+#include "../trace/trace.hpp"
+#include "artifact_cache.hpp"
+#include "capture.hpp"
+#include "memory.hpp"
+#include "numa.hpp"
+#include "requests.hpp"
+#include "sizes.hpp"
 #include <common/timer.hpp>
 #include <common/container.hpp>
 #include <common/map.hpp>
+#include <common/throw_or_abort.hpp>
 
 #include <plonk/composer/turbo/compute_verification_key.hpp>
 #include <plonk/proof_system/proving_key/proving_key.hpp>
@@ -25,12 +41,16 @@ using namespace ::rollup::proofs;
 using namespace plonk::stdlib::merkle_tree;
 using namespace serialize;
 namespace tx_rollup = ::rollup::proofs::rollup;
+namespace metrics = ::rollup::metrics;
+namespace trace = ::rollup::trace;
+namespace requests = ::rollup::requests;
 
 namespace {
-// Number of transactions in an inner rollup.
-size_t txs_per_inner;
-// Number of inner rollups in a root rollup.
-size_t inners_per_root;
+// Sizes of tx rollup circuits, in txs, ascending. Each tx rollup is proven with the smallest that fits it.
+std::vector<size_t> txs_per_inner;
+// Sizes of root rollup circuits, in inner rollups, ascending. There's a root rollup circuit of each size for each tx
+// rollup size, and each root rollup is proven with the smallest that fits it.
+std::vector<size_t> inners_per_root;
 // In mock mode, mock proofs (expected public inputs, but no constraints) are generated.
 bool mock_proofs;
 // Create big circuits proving keys lazily to improve startup times.
@@ -40,43 +60,347 @@ bool lazy_init;
 bool persist;
 // Path to save proving keys to if persist is on.
 std::string data_path;
+// NUMA node to bind the prover to. "none" to disable, "auto" to pick the next free node, or a node id.
+std::string numa_mode;
+// Soft resident memory cap in MB, 0 for none. A non zero cap enables out-of-core mode: proving keys are persisted and
+// served from memory mapped files (so the kernel can evict their pages under pressure), and only the proving key of
+// the proof currently being constructed is kept. If a proof still leaves us over the cap, every proving key is freed.
+// The prover's own allocations aren't bounded, so a single proof can go over.
+size_t memory_cap_mb;
+// Path of a Prometheus text file to export metrics to, blank for none.
+std::string metrics_path;
+// Directory to write Chrome traces of proof requests to, blank for none.
+std::string trace_path;
+// Trace one in this many proof requests.
+size_t trace_sample_every;
+// Path to record requests to, for replay with rollup_replay. Blank for none.
+std::string capture_path;
+// Bytes of recently returned proofs to keep for requests to refer to by hash, in MB. 0 disables by reference requests.
+size_t artifact_cache_mb;
+// Threads making the join-split and tx rollup padding proofs in the background, rather than as each circuit's keys are
+// made. 0 disables the pool. Padding proofs are persisted under the data path if persist is on.
+size_t proof_pool_workers;
+// Tx rollups of a block request proven at once, each with its own copy of the proving key, mapped from its persisted
+// file. Each proof already uses every core, so more only pays while proofs leave cores idle. Needs persist, and isn't
+// available out-of-core.
+size_t block_provers;
+// Build the tx rollup and root rollup circuits with `select_matches`, which matches asset ids and bridge call datas by
+// prover selected entries in fewer gates. These are different circuits, with their own keys and root verifier keys.
+bool select_matches;
 
 std::shared_ptr<waffle::DynamicFileReferenceStringFactory> crs;
 join_split::circuit_data js_cd;
 account::circuit_data account_cd;
 claim::circuit_data claim_cd;
-tx_rollup::circuit_data tx_rollup_cd;
-root_rollup::circuit_data root_rollup_cd;
+// By number of txs.
+std::map<size_t, tx_rollup::circuit_data> tx_rollup_cds;
+// The extra block provers' copies of the tx rollup circuit data, by number of txs.
+std::map<size_t, std::vector<tx_rollup::circuit_data>> block_prover_cds;
+// By number of txs per inner rollup, then number of inner rollups.
+std::map<std::pair<size_t, size_t>, root_rollup::circuit_data> root_rollup_cds;
 root_verifier::circuit_data root_verifier_cd;
+std::unique_ptr<::rollup::artifact_cache::ArtifactCache> artifacts;
+// Held while proving with a tx rollup proving key, which the proof pool's workers also prove padding proofs with. So a
+// proof can wait on a padding proof being made, though no longer than it would have taken to make it in turn.
+std::mutex tx_rollup_key_mutex;
+// Destroyed before the mutex, as its workers may be proving.
+std::unique_ptr<ProofPool> proof_pool;
 } // namespace
 
-// Postcondition: tx_rollup_cd has a proving key and verification key.
-void init_tx_rollup(size_t num_txs)
+bool out_of_core()
 {
-    if (tx_rollup_cd.proving_key) {
-        // We always have a vk if we have a pk, as we request both in the call to get_circuit_data.
+    return memory_cap_mb > 0 && persist;
+}
+
+std::string shape_name(size_t num_txs, size_t num_inners)
+{
+    return format(num_txs, "x", num_inners);
+}
+
+/**
+ * The size a root rollup circuit is padded to, in txs, by which the root verifier tells root rollups apart.
+ */
+size_t root_rollup_size(size_t num_txs, size_t num_inners)
+{
+    return ::rollup::sizes::pow2(num_inners * ::rollup::sizes::pow2(num_txs));
+}
+
+/**
+ * The pool source of a circuit's padding proof, which is only valid for the circuit with that verification key.
+ */
+std::string padding_source(std::string const& circuit, waffle::verification_key& vk)
+{
+    return format(circuit, "_padding_", mock_proofs ? "mock_" : "", from_buffer<uint256_t>(vk.sha256_hash()));
+}
+
+/**
+ * Fills in the join-split padding proof, which tx rollups are padded with, from the pool if it's making it.
+ */
+void init_join_split_padding()
+{
+    if (js_cd.padding_proof.empty() && proof_pool) {
+        js_cd.padding_proof = proof_pool->get(padding_source("join_split", *js_cd.verification_key));
+    }
+}
+
+/**
+ * Fills in a tx rollup's padding proof, which root rollups are padded with, from the pool if it's making it.
+ */
+void init_tx_rollup_padding(tx_rollup::circuit_data& cd)
+{
+    if (cd.padding_proof.empty() && proof_pool) {
+        cd.padding_proof = proof_pool->get(padding_source(format("tx_rollup_", cd.num_txs), *cd.verification_key));
+    }
+}
+
+/**
+ * Frees the proving keys that aren't kept alongside `keep`'s. In lazy init mode only one tx rollup or root rollup
+ * proving key is kept. Out-of-core, only one proving key of any circuit is.
+ */
+void purge_proving_keys(proofs::circuit_data const& keep)
+{
+    bool keeping_root_verifier = &keep == &root_verifier_cd;
+    if ((lazy_init && !keeping_root_verifier) || out_of_core()) {
+        for (auto& [num_txs, cd] : tx_rollup_cds) {
+            if (&cd != &keep && cd.proving_key) {
+                info("Purging tx rollup ", num_txs, " proving key.");
+                cd.proving_key.reset();
+            }
+        }
+        for (auto& [num_txs, copies] : block_prover_cds) {
+            if (&tx_rollup_cds[num_txs] != &keep) {
+                copies.clear();
+            }
+        }
+        for (auto& [shape, cd] : root_rollup_cds) {
+            if (&cd != &keep && cd.proving_key) {
+                info("Purging root rollup ", shape_name(shape.first, shape.second), " proving key.");
+                cd.proving_key.reset();
+            }
+        }
+    }
+    if (out_of_core() && !keeping_root_verifier && root_verifier_cd.proving_key) {
+        info("Purging root verifier proving key.");
+        root_verifier_cd.proving_key.reset();
+    }
+}
+
+/**
+ * Gets a circuit's data with `get(compute, save, load)`. Out-of-core, proving keys must be memory mapped from their
+ * persisted files, which is how get_circuit_data loads them. So keys already on disk are only loaded, and missing ones
+ * are computed and persisted, then the computed key is freed and the persisted one mapped in.
+ */
+template <typename Get> auto get_keys(Get const& get, bool padding)
+{
+    if (!out_of_core()) {
+        return get(true, persist, persist);
+    }
+    auto cd = get(false, false, true);
+    if (cd.proving_key && cd.verification_key && (!padding || !cd.padding_proof.empty())) {
+        return cd;
+    }
+    cd = get(true, true, true);
+    cd.proving_key.reset();
+    return get(false, false, true);
+}
+
+/**
+ * Logs memory use after a proof. Over the cap, every proving key is freed, unmapping those mapped out-of-core, and
+ * freed heap is returned to the kernel. Keys are reloaded by the next proof that needs them.
+ */
+void enforce_memory_cap(std::string const& name)
+{
+    if (::rollup::memory::report(name, memory_cap_mb) || !out_of_core()) {
         return;
     }
-    if (lazy_init) {
-        // In lazy init mode we conserve memory. Throw away the root rollup proving key first.
-        info("Purging root rollup proving key.");
-        root_rollup_cd.proving_key.reset();
+    info(name, ": Freeing all proving keys to get back under the memory cap.");
+    for (auto& [num_txs, cd] : tx_rollup_cds) {
+        cd.proving_key.reset();
+    }
+    for (auto& [shape, cd] : root_rollup_cds) {
+        cd.proving_key.reset();
     }
-    tx_rollup_cd = tx_rollup::get_circuit_data(
-        num_txs, js_cd, account_cd, claim_cd, crs, data_path, true, persist, persist, true, true, mock_proofs);
+    root_verifier_cd.proving_key.reset();
+    ::rollup::memory::release_free_heap();
+    ::rollup::memory::report(name, memory_cap_mb);
 }
 
-bool create_tx_rollup()
+/**
+ * Responds to a proof request that can't be served as if its proof failed.
+ */
+bool reject(std::string const& request, std::string const& reason)
 {
-    init_tx_rollup(txs_per_inner);
+    info("Rejecting ", request, ": ", reason);
+    write(std::cout, std::vector<uint8_t>());
+    write(std::cout, false);
+    std::cout << std::flush;
+    return false;
+}
 
+std::string proof_labels(std::string const& request, std::string const& size)
+{
+    return metrics::label("request", request) + "," + metrics::label("size", size);
+}
+
+/**
+ * Keeps a proof we're returning, so the request that consumes it can refer to it by hash.
+ */
+void cache_artifact(std::vector<uint8_t> const& artifact)
+{
+    if (!artifacts || artifact.empty()) {
+        return;
+    }
+    artifacts->put(artifact);
+    metrics::registry().set("rollup_cli_artifact_cache_bytes", "", static_cast<double>(artifacts->size()));
+}
+
+/**
+ * Replaces the 32 byte hashes of cached artifacts with the artifacts. Returns false if any isn't cached, in which case
+ * the request should be resent with the artifacts inline.
+ */
+bool resolve_artifact(std::vector<uint8_t>& ref)
+{
+    std::vector<uint8_t> const* artifact = nullptr;
+    ::rollup::artifact_cache::Hash key;
+    if (artifacts && ref.size() == key.size()) {
+        std::copy(ref.begin(), ref.end(), key.begin());
+        artifact = artifacts->get(key);
+    }
+    metrics::registry().increment("rollup_cli_artifact_cache_lookups_total",
+                                  metrics::label("result", artifact ? "hit" : "miss"));
+    if (!artifact) {
+        return false;
+    }
+    ref = *artifact;
+    return true;
+}
+
+// Postcondition: the tx rollup circuit data for `num_txs` has a proving key and verification key.
+tx_rollup::circuit_data& init_tx_rollup(size_t num_txs)
+{
+    auto& cd = tx_rollup_cds[num_txs];
+    if (cd.proving_key) {
+        // We always have a vk if we have a pk, as we request both in the call to get_circuit_data.
+        return cd;
+    }
+    purge_proving_keys(cd);
+    init_join_split_padding();
+    // With a pool, the padding proof is made by one of its workers, rather than before the keys can be used.
+    bool padding = !proof_pool;
+    cd = get_keys(
+        [&](bool compute, bool save, bool load) {
+            return tx_rollup::get_circuit_data(num_txs,
+                                               js_cd,
+                                               account_cd,
+                                               claim_cd,
+                                               crs,
+                                               data_path,
+                                               compute,
+                                               save,
+                                               load,
+                                               true,
+                                               true,
+                                               mock_proofs,
+                                               padding,
+                                               select_matches);
+        },
+        padding);
+
+    auto source = padding_source(format("tx_rollup_", num_txs), *cd.verification_key);
+    if (proof_pool && !proof_pool->has(source)) {
+        // The copy holds the keys until the padding proof is made, even if they're purged here first.
+        proof_pool->add_shared(source, [padding_cd = cd](size_t) {
+            std::lock_guard<std::mutex> lock(tx_rollup_key_mutex);
+            auto rollup = tx_rollup::create_padding_rollup(padding_cd.num_txs,
+                                                           padding_cd.join_split_circuit_data.padding_proof);
+            return tx_rollup::verify(rollup, padding_cd).proof_data;
+        });
+    }
+    return cd;
+}
+
+/**
+ * The circuit data each of a block's provers proves tx rollups with: `cd`, then copies with their own proving key,
+ * mapped from the one persisted for `cd`. Fewer than `block_provers` if that can't be loaded.
+ */
+std::vector<tx_rollup::circuit_data*> block_prover_keys(tx_rollup::circuit_data& cd)
+{
+    std::vector<tx_rollup::circuit_data*> keys = { &cd };
+    auto& copies = block_prover_cds[cd.num_txs];
+    while (copies.size() + 1 < block_provers) {
+        auto loaded = tx_rollup::get_circuit_data(cd.num_txs,
+                                                  js_cd,
+                                                  account_cd,
+                                                  claim_cd,
+                                                  crs,
+                                                  data_path,
+                                                  false,
+                                                  false,
+                                                  true,
+                                                  true,
+                                                  false,
+                                                  mock_proofs,
+                                                  false,
+                                                  select_matches);
+        if (!loaded.proving_key) {
+            info("No persisted tx rollup ", cd.num_txs, " proving key to copy.");
+            break;
+        }
+        copies.push_back(cd);
+        copies.back().proving_key = loaded.proving_key;
+    }
+    for (auto& copy : copies) {
+        keys.push_back(&copy);
+    }
+    return keys;
+}
+
+/**
+ * A block's tx rollups must all be proven with the same size of circuit to be rolled up together, which is a choice for
+ * the whole block that a lone tx rollup can't make. With `sized`, the request starts with the size (uint32) the client
+ * chose for the block. Otherwise the largest size is used, which every block fits.
+ */
+bool create_tx_rollup(bool sized)
+{
+    trace::Request trace_request("tx_rollup");
+
+    uint32_t size = 0;
     tx_rollup::rollup_tx rollup;
     std::cerr << "Reading tx rollup..." << std::endl;
+    metrics::ScopedTimer read_timer("rollup_cli_request_read_seconds", metrics::label("request", "tx_rollup"));
+    trace::Span read_span("read request", "io");
+    if (sized) {
+        read(std::cin, size);
+    }
     read(std::cin, rollup);
+    read_span.stop();
+    read_timer.stop();
     std::cerr << "Received tx rollup with " << rollup.num_txs << " txs." << std::endl;
 
-    auto result = verify(rollup, tx_rollup_cd);
+    size_t num_txs = sized ? size : txs_per_inner.back();
+    if (!std::binary_search(txs_per_inner.begin(), txs_per_inner.end(), num_txs)) {
+        return reject("tx rollup", format("no tx rollup circuit of size ", num_txs));
+    }
+    if (rollup.num_txs > num_txs) {
+        return reject("tx rollup", format(rollup.num_txs, " txs is more than the circuit's ", num_txs));
+    }
+    info("Proving with the ", num_txs, " tx rollup circuit.");
+    trace::Span init_span("init circuit data", "keys");
+    auto& cd = init_tx_rollup(num_txs);
+    init_span.stop();
+
+    metrics::ScopedTimer proof_timer("rollup_cli_proof_seconds", proof_labels("tx_rollup", std::to_string(num_txs)));
+    std::unique_lock<std::mutex> key_lock(tx_rollup_key_mutex);
+    auto result = verify(rollup, cd);
+    key_lock.unlock();
+    proof_timer.stop();
+    enforce_memory_cap("tx rollup");
+    if (result.verified) {
+        cache_artifact(result.proof_data);
+    }
 
+    metrics::ScopedTimer write_timer("rollup_cli_response_write_seconds", metrics::label("request", "tx_rollup"));
+    trace::Span write_span("write response", "io");
     write(std::cout, result.proof_data);
     write(std::cout, result.verified);
     std::cout << std::flush;
@@ -84,40 +408,90 @@ bool create_tx_rollup()
     return result.verified;
 }
 
-// Postcondition: root_rollup_cd has a proving key and verification key.
-void init_root_rollup(size_t num_rollups)
+// Postcondition: the root rollup circuit data for the shape has a proving key and verification key.
+root_rollup::circuit_data& init_root_rollup(size_t num_txs, size_t num_inners)
 {
-    if (root_rollup_cd.proving_key) {
+    auto& cd = root_rollup_cds[{ num_txs, num_inners }];
+    if (cd.proving_key) {
         // We always have a vk if we have a pk, as we request both in the call to get_circuit_data.
-        return;
+        return cd;
     }
+    auto& tx_rollup_cd = tx_rollup_cds[num_txs];
     if (!tx_rollup_cd.verification_key) {
         // If we've never created the tx rollup circuit data, we won't have a vk. Build it.
-        init_tx_rollup(txs_per_inner);
+        init_tx_rollup(num_txs);
     }
-    if (lazy_init) {
-        // In lazy init mode we conserve memory. Throw away the tx rollup proving key first.
-        info("Purging tx rollup proving key.");
-        tx_rollup_cd.proving_key.reset();
-    }
-    root_rollup_cd = root_rollup::get_circuit_data(
-        num_rollups, tx_rollup_cd, crs, data_path, true, persist, persist, true, true, mock_proofs);
+    init_tx_rollup_padding(tx_rollup_cd);
+    purge_proving_keys(cd);
+    cd = get_keys(
+        [&](bool compute, bool save, bool load) {
+            return root_rollup::get_circuit_data(
+                num_inners, tx_rollup_cd, crs, data_path, compute, save, load, true, true, mock_proofs);
+        },
+        true);
+    return cd;
 }
 
-bool create_root_rollup()
+/**
+ * With `by_reference`, the request's inner rollups are the hashes of tx rollup proofs we returned.
+ */
+bool create_root_rollup(bool by_reference)
 {
-    init_root_rollup(inners_per_root);
+    trace::Request trace_request("root_rollup");
 
     root_rollup::root_rollup_tx root_rollup;
     std::cerr << "Reading root rollup..." << std::endl;
+    metrics::ScopedTimer read_timer("rollup_cli_request_read_seconds", metrics::label("request", "root_rollup"));
+    trace::Span read_span("read request", "io");
     read(std::cin, root_rollup);
+    read_span.stop();
+    read_timer.stop();
     std::cerr << "Received root rollup with " << root_rollup.rollups.size() << " rollups." << std::endl;
 
-    auto result = verify(root_rollup, root_rollup_cd);
+    if (by_reference) {
+        for (auto& inner : root_rollup.rollups) {
+            if (!resolve_artifact(inner)) {
+                return reject("root rollup", "inner rollup proof not in the artifact cache");
+            }
+        }
+    }
+
+    // The inner rollups say the size they were proven with, which picks the root rollup circuits that can verify them.
+    if (root_rollup.rollups.empty()) {
+        return reject("root rollup", "no inner rollups");
+    }
+    auto inner_size = tx_rollup::rollup_proof_data(root_rollup.rollups[0]).rollup_size;
+    auto num_txs = std::find_if(txs_per_inner.begin(), txs_per_inner.end(), [&](size_t size) {
+        return ::rollup::sizes::pow2(size) == inner_size;
+    });
+    if (num_txs == txs_per_inner.end()) {
+        return reject("root rollup", format("no tx rollup circuit of size ", inner_size));
+    }
+    auto num_inners = ::rollup::sizes::smallest_fitting(inners_per_root, root_rollup.rollups.size());
+    if (!num_inners) {
+        return reject("root rollup",
+                      format(root_rollup.rollups.size(), " inner rollups is more than the largest circuit's ",
+                             inners_per_root.back()));
+    }
+    auto shape = shape_name(*num_txs, *num_inners);
+    info("Proving with the ", shape, " root rollup circuit.");
+    trace::Span init_span("init circuit data", "keys");
+    auto& cd = init_root_rollup(*num_txs, *num_inners);
+    init_span.stop();
+
+    metrics::ScopedTimer proof_timer("rollup_cli_proof_seconds", proof_labels("root_rollup", shape));
+    auto result = verify(root_rollup, cd);
+    proof_timer.stop();
+    enforce_memory_cap("root rollup");
 
     root_rollup::root_rollup_broadcast_data broadcast_data(result.broadcast_data);
     auto buf = join({ to_buffer(broadcast_data), result.proof_data });
+    if (result.verified) {
+        cache_artifact(buf);
+    }
 
+    metrics::ScopedTimer write_timer("rollup_cli_response_write_seconds", metrics::label("request", "root_rollup"));
+    trace::Span write_span("write response", "io");
     write(std::cout, buf);
     write(std::cout, result.verified);
     std::cout << std::flush;
@@ -127,12 +501,19 @@ bool create_root_rollup()
 
 bool create_claim()
 {
+    trace::Request trace_request("claim");
     claim::claim_tx claim_tx;
     std::cerr << "Reading claim tx..." << std::endl;
+    metrics::ScopedTimer read_timer("rollup_cli_request_read_seconds", metrics::label("request", "claim"));
+    trace::Span read_span("read request", "io");
     read(std::cin, claim_tx);
+    read_span.stop();
+    read_timer.stop();
 
     auto result = verify(claim_tx, claim_cd);
 
+    metrics::ScopedTimer write_timer("rollup_cli_response_write_seconds", metrics::label("request", "claim"));
+    trace::Span write_span("write response", "io");
     write(std::cout, result.proof_data);
     write(std::cout, result.verified);
     std::cout << std::flush;
@@ -140,6 +521,24 @@ bool create_claim()
     return result.verified;
 }
 
+/**
+ * The root verifier's keys depend on the root rollup circuits it accepts, of which its file name only captures the
+ * number. So unless there's just the one default circuit, they're kept apart by the sizes and variant they were built
+ * for.
+ */
+std::string root_verifier_key_path()
+{
+    if (txs_per_inner.size() == 1 && inners_per_root.size() == 1 && !select_matches) {
+        return data_path;
+    }
+    return format(data_path,
+                  "/root_verifier_",
+                  ::rollup::sizes::to_string(txs_per_inner),
+                  "x",
+                  ::rollup::sizes::to_string(inners_per_root),
+                  select_matches ? "_selected" : "");
+}
+
 // Postcondition: root_verifier_cd has a proving key and verification key.
 void init_root_verifier()
 {
@@ -147,36 +546,84 @@ void init_root_verifier()
         // We always have a vk if we have a pk, as we request both in the call to get_circuit_data.
         return;
     }
-    if (!root_rollup_cd.verification_key) {
-        // If we've never created the root rollup circuit data, we won't have a vk. Build it.
-        init_root_rollup(txs_per_inner);
-    }
-    root_verifier_cd = root_verifier::get_circuit_data(root_rollup_cd,
-                                                       crs,
-                                                       { root_rollup_cd.verification_key },
-                                                       data_path,
-                                                       true,
-                                                       persist,
-                                                       persist,
-                                                       true,
-                                                       true,
-                                                       mock_proofs);
+    // The root verifier accepts a proof from any of the root rollup circuits, so needs all their vks.
+    std::vector<std::shared_ptr<waffle::verification_key>> valid_vks;
+    for (auto num_txs : txs_per_inner) {
+        for (auto num_inners : inners_per_root) {
+            auto& cd = root_rollup_cds[{ num_txs, num_inners }];
+            if (!cd.verification_key) {
+                // If we've never created the root rollup circuit data, we won't have a vk. Build it.
+                init_root_rollup(num_txs, num_inners);
+            }
+            valid_vks.push_back(cd.verification_key);
+        }
+    }
+    purge_proving_keys(root_verifier_cd);
+    auto& root_rollup_cd = root_rollup_cds[{ txs_per_inner.back(), inners_per_root.back() }];
+    auto key_path = root_verifier_key_path();
+    root_verifier_cd = get_keys(
+        [&](bool compute, bool save, bool load) {
+            return root_verifier::get_circuit_data(
+                root_rollup_cd, crs, valid_vks, key_path, compute, save, load, true, true, mock_proofs);
+        },
+        false);
 }
 
-bool create_root_verifier()
+/**
+ * With `by_reference`, the request is the hash of a root rollup response we returned, rather than the response.
+ */
+bool create_root_verifier(bool by_reference)
 {
-    init_root_verifier();
+    trace::Request trace_request("root_verifier");
+    {
+        trace::Span span("init circuit data", "keys");
+        init_root_verifier();
+    }
 
     std::vector<uint8_t> root_rollup_proof_buf;
     std::cerr << "Reading root verifier tx..." << std::endl;
+    metrics::ScopedTimer read_timer("rollup_cli_request_read_seconds", metrics::label("request", "root_verifier"));
+    trace::Span read_span("read request", "io");
     read(std::cin, root_rollup_proof_buf);
+    read_span.stop();
+    read_timer.stop();
 
-    auto rollup_size = inners_per_root * tx_rollup_cd.rollup_size;
-    auto tx = root_verifier::create_root_verifier_tx(root_rollup_proof_buf, rollup_size);
+    if (by_reference && !resolve_artifact(root_rollup_proof_buf)) {
+        return reject("root verifier", "root rollup proof not in the artifact cache");
+    }
 
+    // The broadcast data says the size of the root rollup, which is distinct for each root rollup circuit.
+    auto size_offset = root_rollup::RootRollupBroadcastFields::ROLLUP_SIZE * 32;
+    if (root_rollup_proof_buf.size() < size_offset + 32) {
+        return reject("root verifier", "truncated root rollup proof");
+    }
+    auto rollup_size = static_cast<size_t>(from_buffer<uint256_t>(root_rollup_proof_buf, size_offset));
+    auto shape = root_rollup_cds.end();
+    for (auto num_txs : txs_per_inner) {
+        for (auto num_inners : inners_per_root) {
+            if (root_rollup_size(num_txs, num_inners) == rollup_size) {
+                shape = root_rollup_cds.find({ num_txs, num_inners });
+            }
+        }
+    }
+    if (shape == root_rollup_cds.end()) {
+        return reject("root verifier", format("no root rollup circuit of size ", rollup_size));
+    }
+    auto const& [num_txs, num_inners] = shape->first;
+    auto const& root_rollup_cd = shape->second;
+
+    auto broadcast_size = num_inners * root_rollup_cd.inner_rollup_circuit_data.rollup_size;
+    auto tx = root_verifier::create_root_verifier_tx(root_rollup_proof_buf, broadcast_size);
+
+    metrics::ScopedTimer proof_timer("rollup_cli_proof_seconds",
+                                     proof_labels("root_verifier", shape_name(num_txs, num_inners)));
     auto result = verify(tx, root_verifier_cd, root_rollup_cd);
+    proof_timer.stop();
+    enforce_memory_cap("root verifier");
 
     result.proof_data = join({ tx.broadcast_data, result.proof_data });
+    metrics::ScopedTimer write_timer("rollup_cli_response_write_seconds", metrics::label("request", "root_verifier"));
+    trace::Span write_span("write response", "io");
     write(std::cout, result.proof_data);
     write(std::cout, (uint8_t)result.verified);
     std::cout << std::flush;
@@ -184,14 +631,177 @@ bool create_root_verifier()
     return result.verified;
 }
 
+/**
+ * Proves a whole block in one request: its tx rollups, the root rollup of them, and the root verifier of that. The
+ * request is the tx rollups, then the root rollup tx without its inner rollups, which are filled in with the tx rollup
+ * proofs. Each stage's response is written as it's done, in the format of the request for that stage alone, stopping
+ * at the first that fails.
+ *
+ * The tx rollups are all proven with the smallest circuit that fits the largest of them. Proving writes to the
+ * circuit's proving key, so each key proves one tx rollup at a time. With the default single block prover, they're
+ * proven in turn, with the circuit of the next built on another thread while the current one is proven. More block
+ * provers each get a copy of the key, and prove that many tx rollups at once.
+ */
+bool create_block()
+{
+    trace::Request trace_request("block");
+
+    std::vector<tx_rollup::rollup_tx> tx_rollups;
+    root_rollup::root_rollup_tx root_rollup;
+    std::cerr << "Reading block..." << std::endl;
+    metrics::ScopedTimer read_timer("rollup_cli_request_read_seconds", metrics::label("request", "block"));
+    trace::Span read_span("read request", "io");
+    read(std::cin, tx_rollups);
+    read(std::cin, root_rollup);
+    read_span.stop();
+    read_timer.stop();
+    std::cerr << "Received block with " << tx_rollups.size() << " tx rollups." << std::endl;
+
+    if (tx_rollups.empty()) {
+        return reject("block", "no tx rollups");
+    }
+    uint32_t largest = 0;
+    for (auto const& rollup : tx_rollups) {
+        largest = std::max(largest, rollup.num_txs);
+    }
+    auto selected_txs = ::rollup::sizes::smallest_fitting(txs_per_inner, largest);
+    if (!selected_txs) {
+        return reject("block",
+                      format(largest, " txs is more than the largest tx rollup circuit's ", txs_per_inner.back()));
+    }
+    auto num_txs = *selected_txs;
+    auto selected_inners = ::rollup::sizes::smallest_fitting(inners_per_root, tx_rollups.size());
+    if (!selected_inners) {
+        return reject("block",
+                      format(tx_rollups.size(), " tx rollups is more than the largest root rollup circuit's ",
+                             inners_per_root.back()));
+    }
+    auto num_inners = *selected_inners;
+    auto shape = shape_name(num_txs, num_inners);
+    info("Proving block with the ", shape, " root rollup circuit.");
+    metrics::ScopedTimer block_timer("rollup_cli_block_seconds", metrics::label("size", shape));
+
+    trace::Span tx_init_span("init circuit data", "keys", "tx rollup");
+    auto& tx_cd = init_tx_rollup(num_txs);
+    tx_init_span.stop();
+
+    auto keys = block_prover_keys(tx_cd);
+    auto num_provers = keys.size();
+    // Set once a tx rollup fails, so the ones still being built or waiting for a key give up.
+    std::atomic<bool> failed(false);
+    using Proof = std::shared_future<verify_result<tx_rollup::Composer>>;
+    std::vector<Proof> proofs(tx_rollups.size());
+    // Builds a tx rollup's circuit, then proves it once `before`, the tx rollup before it with the same key, is done.
+    auto prove = [&](size_t i, Proof before) {
+        auto& cd = *keys[i % num_provers];
+        verify_result<tx_rollup::Composer> result;
+        if (failed) {
+            return result;
+        }
+        tx_rollup::Composer composer(cd.proving_key, cd.verification_key, cd.num_gates);
+        result = tx_rollup::verify_logic(composer, tx_rollups[i], cd);
+        if (before.valid()) {
+            before.wait();
+        }
+        if (failed || !result.logic_verified) {
+            return result;
+        }
+        metrics::ScopedTimer proof_timer("rollup_cli_proof_seconds",
+                                         proof_labels("tx_rollup", std::to_string(num_txs)));
+        // The first key is the one the proof pool makes padding proofs with.
+        std::unique_lock<std::mutex> key_lock(tx_rollup_key_mutex, std::defer_lock);
+        if (&cd == &tx_cd) {
+            key_lock.lock();
+        }
+        return tx_rollup::prove(composer, std::move(result), cd);
+    };
+    // Out-of-core, holding a second circuit could push us over the memory cap, so circuits are built in turn.
+    auto policy = out_of_core() ? std::launch::deferred : std::launch::async;
+    // As many tx rollups as there are provers are proven at once, and one more built ahead.
+    size_t launched = 0;
+    auto launch_upto = [&](size_t end) {
+        for (; launched < std::min(end, tx_rollups.size()); ++launched) {
+            auto before = launched >= num_provers ? proofs[launched - num_provers] : Proof();
+            proofs[launched] = std::async(policy, prove, launched, before).share();
+        }
+    };
+    launch_upto(num_provers + 1);
+    root_rollup.rollups.clear();
+    for (size_t i = 0; i < tx_rollups.size(); ++i) {
+        auto result = proofs[i].get();
+        launch_upto(i + num_provers + 2);
+        // The rest of the block's tx rollups need the keys, so they aren't freed until they're done.
+        ::rollup::memory::report("tx rollup", memory_cap_mb);
+
+        trace::Span write_span("write response", "io", "tx rollup");
+        write(std::cout, result.proof_data);
+        write(std::cout, result.verified);
+        std::cout << std::flush;
+        write_span.stop();
+        if (!result.verified) {
+            // The rest give up, and returning waits for them, as their futures block on destruction.
+            failed = true;
+            return false;
+        }
+        root_rollup.rollups.push_back(std::move(result.proof_data));
+    }
+
+    enforce_memory_cap("tx rollup");
+
+    // The root rollup's witness is all of the inner proofs, so it can't be built until the last is done.
+    root_rollup.num_inner_proofs = static_cast<uint32_t>(root_rollup.rollups.size());
+    trace::Span root_init_span("init circuit data", "keys", "root rollup");
+    auto& root_cd = init_root_rollup(num_txs, num_inners);
+    root_init_span.stop();
+
+    metrics::ScopedTimer root_proof_timer("rollup_cli_proof_seconds", proof_labels("root_rollup", shape));
+    auto root_result = verify(root_rollup, root_cd);
+    root_proof_timer.stop();
+    enforce_memory_cap("root rollup");
+
+    root_rollup::root_rollup_broadcast_data broadcast_data(root_result.broadcast_data);
+    trace::Span root_write_span("write response", "io", "root rollup");
+    write(std::cout, join({ to_buffer(broadcast_data), root_result.proof_data }));
+    write(std::cout, root_result.verified);
+    std::cout << std::flush;
+    root_write_span.stop();
+    if (!root_result.verified) {
+        return false;
+    }
+
+    trace::Span verifier_init_span("init circuit data", "keys", "root verifier");
+    init_root_verifier();
+    verifier_init_span.stop();
+
+    auto verifier_tx = root_verifier::create_root_verifier_tx(root_result);
+    metrics::ScopedTimer verifier_proof_timer("rollup_cli_proof_seconds", proof_labels("root_verifier", shape));
+    auto verifier_result = verify(verifier_tx, root_verifier_cd, root_cd);
+    verifier_proof_timer.stop();
+    enforce_memory_cap("root verifier");
+
+    trace::Span verifier_write_span("write response", "io", "root verifier");
+    write(std::cout, join({ verifier_tx.broadcast_data, verifier_result.proof_data }));
+    write(std::cout, (uint8_t)verifier_result.verified);
+    std::cout << std::flush;
+
+    return verifier_result.verified;
+}
+
 bool create_account_proof()
 {
+    trace::Request trace_request("account");
     account::account_tx account_tx;
     std::cerr << "Reading account tx..." << std::endl;
+    metrics::ScopedTimer read_timer("rollup_cli_request_read_seconds", metrics::label("request", "account"));
+    trace::Span read_span("read request", "io");
     read(std::cin, account_tx);
+    read_span.stop();
+    read_timer.stop();
 
     auto result = verify(account_tx, account_cd);
 
+    metrics::ScopedTimer write_timer("rollup_cli_response_write_seconds", metrics::label("request", "account"));
+    trace::Span write_span("write response", "io");
     write(std::cout, result.proof_data);
     write(std::cout, result.verified);
     std::cout << std::flush;
@@ -199,6 +809,24 @@ bool create_account_proof()
     return result.verified;
 }
 
+/**
+ * Parses the optional argument at `index` into `value`, which keeps its default if the argument isn't given. Returns
+ * false if it isn't a non negative integer.
+ */
+bool parse_count(std::vector<std::string> const& args, size_t index, size_t& value)
+{
+    if (args.size() <= index) {
+        return true;
+    }
+    auto parsed = ::rollup::sizes::parse_count(args[index]);
+    if (!parsed) {
+        std::cerr << "Argument " << index << " must be a non negative integer, not: " << args[index] << std::endl;
+        return false;
+    }
+    value = *parsed;
+    return true;
+}
+
 int main(int argc, char** argv)
 {
     std::vector<std::string> args(argv, argv + argc);
@@ -207,30 +835,114 @@ int main(int argc, char** argv)
     info("Command line: ", join(args, " "));
 
     const std::string srs_path = (args.size() > 1) ? args[1] : "../barretenberg/cpp/srs_db/ignition";
-    txs_per_inner = args.size() > 2 ? (std::stoul(args[2])) : 1;
-    inners_per_root = args.size() > 3 ? (std::stoul(args[3])) : 1;
+    txs_per_inner = ::rollup::sizes::parse(args.size() > 2 ? args[2] : "1");
+    inners_per_root = ::rollup::sizes::parse(args.size() > 3 ? args[3] : "1");
+    if (txs_per_inner.empty() || inners_per_root.empty()) {
+        return 1;
+    }
     mock_proofs = args.size() > 4 ? args[4] == "true" : false;
     lazy_init = args.size() > 5 ? args[5] == "true" : false;
     persist = args.size() > 6 ? args[6] == "true" : true;
     data_path = (args.size() > 7) ? args[7] : "./data";
+    numa_mode = (args.size() > 8) ? args[8] : "none";
+    memory_cap_mb = 0;
+    metrics_path = (args.size() > 10) ? args[10] : "";
+    trace_path = (args.size() > 11) ? args[11] : "";
+    trace_sample_every = 1;
+    capture_path = (args.size() > 13) ? args[13] : "";
+    artifact_cache_mb = 64;
+    proof_pool_workers = 0;
+    block_provers = 1;
+    select_matches = args.size() > 17 ? args[17] == "true" : false;
+    if (!parse_count(args, 9, memory_cap_mb) || !parse_count(args, 12, trace_sample_every) ||
+        !parse_count(args, 14, artifact_cache_mb) || !parse_count(args, 15, proof_pool_workers) ||
+        !parse_count(args, 16, block_provers)) {
+        return 1;
+    }
 
-    info("Txs per inner: ", txs_per_inner);
-    info("Inners per root: ", inners_per_root);
+    info("Txs per inner: ", ::rollup::sizes::to_string(txs_per_inner));
+    info("Inners per root: ", ::rollup::sizes::to_string(inners_per_root));
     info("Mock proofs: ", mock_proofs);
     info("Lazy init: ", lazy_init);
     info("Persist: ", persist);
     info("Data path: ", data_path);
+    info("NUMA mode: ", numa_mode);
+    info("Memory cap: ", memory_cap_mb, "MB");
+    info("Metrics path: ", metrics_path.empty() ? "none" : metrics_path);
+    info("Trace path: ", trace_path.empty() ? "none" : trace_path);
+    info("Trace sample every: ", trace_sample_every);
+    info("Capture path: ", capture_path.empty() ? "none" : capture_path);
+    info("Artifact cache: ", artifact_cache_mb, "MB");
+    info("Proof pool workers: ", proof_pool_workers);
+    info("Block provers: ", block_provers);
+    info("Select matches: ", select_matches);
 
     if (mock_proofs) {
         info("Running in mock proof mode. Mock proofs will be generated!");
     }
 
+    // The root verifier, and the rollup contract, identify a root rollup circuit by its size.
+    std::map<size_t, std::string> root_rollup_shapes;
+    for (auto num_txs : txs_per_inner) {
+        for (auto num_inners : inners_per_root) {
+            auto size = root_rollup_size(num_txs, num_inners);
+            auto shape = shape_name(num_txs, num_inners);
+            if (root_rollup_shapes.count(size)) {
+                throw_or_abort(format("Root rollups ", root_rollup_shapes[size], " and ", shape, " are both of size ",
+                                      size, ", so can't be told apart."));
+            }
+            root_rollup_shapes[size] = shape;
+        }
+    }
+
+    if (memory_cap_mb && !persist) {
+        info("Memory cap requires persist to be enabled, ignoring.");
+    } else if (out_of_core()) {
+        info("Running out-of-core, proving keys will be memory mapped from disk and swapped per proof.");
+    }
+    if (block_provers > 1 && (!persist || out_of_core())) {
+        info("Block provers need persisted proving keys, and aren't available out-of-core, ignoring.");
+        block_provers = 1;
+    }
+
+    // Bind before anything large is allocated, so the crs and proving keys are first touched on our node.
+    if (numa_mode != "none") {
+        // A `:strict` suffix binds memory to the node, rather than preferring it.
+        auto suffix = numa_mode.rfind(":strict");
+        auto strict = suffix != std::string::npos && suffix + 7 == numa_mode.size();
+        auto node_mode = strict ? numa_mode.substr(0, suffix) : numa_mode;
+        auto nodes = ::rollup::numa::get_topology();
+        ::rollup::numa::print_topology(nodes);
+        auto node_index = ::rollup::numa::select_node(node_mode, nodes);
+        if (node_index >= 0 && ::rollup::numa::bind_to_node(nodes[(size_t)node_index], strict)) {
+            info(strict ? "Bound to NUMA node " : "Preferring NUMA node ", nodes[(size_t)node_index].id);
+        } else {
+            info("Running without NUMA binding.");
+        }
+    }
+
+    if (!trace_path.empty()) {
+        std::filesystem::create_directories(trace_path);
+        trace::tracer().configure(trace_path, trace_sample_every);
+    }
+
     info("Loading crs...");
     crs = std::make_shared<waffle::DynamicFileReferenceStringFactory>(srs_path);
 
+    if (proof_pool_workers) {
+        proof_pool = std::make_unique<ProofPool>(persist ? data_path + "/proof_pool" : "", proof_pool_workers);
+    }
+
     account_cd = account::get_circuit_data(crs, mock_proofs);
-    js_cd = join_split::get_circuit_data(crs, mock_proofs);
+    js_cd = join_split::get_circuit_data(crs, mock_proofs, !proof_pool);
     claim_cd = claim::get_circuit_data(crs, mock_proofs);
+    if (proof_pool) {
+        // Only the pool proves with the join-split key here, so it needs no lock.
+        proof_pool->add_shared(padding_source("join_split", *js_cd.verification_key), [padding_cd = js_cd](size_t) {
+            auto data_root = barretenberg::fr::random_element();
+            return join_split::create_noop_join_split_proof(padding_cd, data_root, true, mock_proofs);
+        });
+    }
 
     // Lazy init mode conserves memory by purging and recomputing tx/root proving keys.
     // If the halloumi instance is targeted to produce a specific type of proof, use lazy init as it will only
@@ -240,13 +952,32 @@ int main(int argc, char** argv)
     // too big. It can be useful for determining to total memory footprint of the process for certain circuit sizes.
     if (!lazy_init) {
         info("Running in eager init mode, all proving keys will be created once up front.");
-        init_tx_rollup(txs_per_inner);
-        init_root_rollup(inners_per_root);
+        for (auto num_txs : txs_per_inner) {
+            init_tx_rollup(num_txs);
+        }
+        for (auto num_txs : txs_per_inner) {
+            for (auto num_inners : inners_per_root) {
+                init_root_rollup(num_txs, num_inners);
+            }
+        }
         init_root_verifier();
     } else {
         info("Running in lazy init mode, tx rollup and root rollup proving keys will be swapped in and out.");
     }
 
+    // Exported at most every 15s, the default Prometheus scrape interval, as proofs can come in faster than that.
+    metrics::PeriodicExporter exporter(metrics_path, std::chrono::seconds(15));
+    exporter.flush();
+
+    if (artifact_cache_mb) {
+        artifacts = std::make_unique<::rollup::artifact_cache::ArtifactCache>(artifact_cache_mb * 1024 * 1024);
+    }
+
+    std::unique_ptr<::rollup::capture::Recorder> recorder;
+    if (!capture_path.empty()) {
+        recorder = std::make_unique<::rollup::capture::Recorder>(capture_path);
+    }
+
     info("Reading rollups from standard input...");
     while (true) {
         if (!std::cin.good() || std::cin.peek() == std::char_traits<char>::eof()) {
@@ -255,41 +986,71 @@ int main(int argc, char** argv)
 
         uint32_t proof_id;
         read(std::cin, proof_id);
+        if (recorder) {
+            recorder->begin(proof_id);
+        }
+
+        auto request = metrics::label("request", requests::name(proof_id));
+        metrics::registry().increment("rollup_cli_requests_total", request);
+        bool success = true;
 
         switch (proof_id) {
-        case 0: {
-            create_tx_rollup();
+        case requests::TX_ROLLUP: {
+            success = create_tx_rollup(false);
             break;
         }
-        case 1: {
-            create_root_rollup();
+        case requests::ROOT_ROLLUP: {
+            success = create_root_rollup(false);
             break;
         }
-        case 2: {
-            create_claim();
+        case requests::CLAIM: {
+            success = create_claim();
             break;
         }
-        case 3: {
-            create_root_verifier();
+        case requests::ROOT_VERIFIER: {
+            success = create_root_verifier(false);
             break;
         }
-        case 4: {
+        case requests::ACCOUNT: {
             std::cerr << "Serving request to create account proof..." << std::endl;
-            create_account_proof();
+            success = create_account_proof();
             break;
         }
-        case 100: {
+        case requests::ROOT_ROLLUP_BY_REFERENCE: {
+            success = create_root_rollup(true);
+            break;
+        }
+        case requests::ROOT_VERIFIER_BY_REFERENCE: {
+            success = create_root_verifier(true);
+            break;
+        }
+        case requests::BLOCK: {
+            success = create_block();
+            break;
+        }
+        case requests::TX_ROLLUP_SIZED: {
+            success = create_tx_rollup(true);
+            break;
+        }
+        case requests::JOIN_SPLIT_VK: {
             // Convert to buffer first, so when we call write we prefix the buffer length.
             std::cerr << "Serving join split vk..." << std::endl;
             write(std::cout, to_buffer(*js_cd.verification_key));
             break;
         }
-        case 101: {
+        case requests::ACCOUNT_VK: {
             std::cerr << "Serving account vk..." << std::endl;
             write(std::cout, to_buffer(*account_cd.verification_key));
             break;
         }
-        case 666: {
+        case requests::STATS: {
+            // Metrics in Prometheus' text format, as written to the metrics file.
+            std::cerr << "Serving stats..." << std::endl;
+            write(std::cout, metrics::registry().to_string());
+            std::cout << std::flush;
+            break;
+        }
+        case requests::PING: {
             // Ping... Pong... Used for learning when rollup_cli is responsive.
             std::cerr << "Ping... Pong..." << std::endl;
             serialize::write(std::cout, true);
@@ -297,10 +1058,20 @@ int main(int argc, char** argv)
         }
         default: {
             std::cerr << "Unknown command: " << proof_id << std::endl;
+            success = false;
             break;
         }
         }
+
+        if (!success) {
+            metrics::registry().increment("rollup_cli_request_failures_total", request);
+        }
+        if (recorder) {
+            recorder->end(success);
+        }
+        exporter.tick();
     }
 
+    exporter.flush();
     return 0;
 }
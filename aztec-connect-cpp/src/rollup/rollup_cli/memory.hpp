@@ -0,0 +1,62 @@
+#pragma once
+#include <common/log.hpp>
+#include <fstream>
+#include <string>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+namespace rollup {
+namespace memory {
+
+/**
+ * Reads a "<field>:    1234 kB" entry from /proc/self/status and returns it in MB, or 0 if unavailable.
+ */
+inline size_t read_proc_status_mb(std::string const& field)
+{
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.rfind(field + ":", 0) == 0) {
+            return std::stoul(line.substr(field.size() + 1)) / 1024;
+        }
+    }
+    return 0;
+}
+
+inline size_t resident_mb()
+{
+    return read_proc_status_mb("VmRSS");
+}
+
+inline size_t peak_resident_mb()
+{
+    return read_proc_status_mb("VmHWM");
+}
+
+/**
+ * Logs current memory usage against the given cap. Returns false if the cap is exceeded.
+ */
+inline bool report(std::string const& name, size_t cap_mb)
+{
+    auto rss = resident_mb();
+    info(name, ": Resident memory: ", rss, "MB (peak ", peak_resident_mb(), "MB, cap ", cap_mb, "MB)");
+    if (cap_mb && rss > cap_mb) {
+        info(name, ": Warning, resident memory exceeds the configured cap.");
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Returns the heap glibc holds on to after frees to the kernel, so freeing a proving key lowers resident memory.
+ */
+inline void release_free_heap()
+{
+#ifdef __GLIBC__
+    malloc_trim(0);
+#endif
+}
+
+} // namespace memory
+} // namespace rollup
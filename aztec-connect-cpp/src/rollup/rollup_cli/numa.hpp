@@ -0,0 +1,210 @@
+#pragma once
+#include <common/log.hpp>
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <sched.h>
+#include <sys/file.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#ifndef NO_MULTITHREADING
+#include <omp.h>
+#endif
+
+namespace rollup {
+namespace numa {
+
+struct numa_node {
+    size_t id;
+    std::vector<size_t> cpus;
+    size_t memory_mb;
+};
+
+/**
+ * Parses a kernel cpu list string, e.g. "0-15,32-47".
+ */
+inline std::vector<size_t> parse_cpu_list(std::string const& list)
+{
+    std::vector<size_t> cpus;
+    std::stringstream ss(list);
+    std::string range;
+    while (std::getline(ss, range, ',')) {
+        if (range.empty() || range == "\n") {
+            continue;
+        }
+        auto dash = range.find('-');
+        auto first = std::stoul(range.substr(0, dash));
+        auto last = dash == std::string::npos ? first : std::stoul(range.substr(dash + 1));
+        for (auto cpu = first; cpu <= last; ++cpu) {
+            cpus.push_back(cpu);
+        }
+    }
+    return cpus;
+}
+
+/**
+ * Reads the NUMA topology exposed by the kernel under /sys/devices/system/node.
+ * Nodes without cpus (memory only nodes) are skipped, as we can't run provers on them.
+ */
+inline std::vector<numa_node> get_topology()
+{
+    std::vector<numa_node> nodes;
+    std::string const sys_path = "/sys/devices/system/node";
+    if (!std::filesystem::exists(sys_path)) {
+        return nodes;
+    }
+
+    for (auto const& entry : std::filesystem::directory_iterator(sys_path)) {
+        auto name = entry.path().filename().string();
+        if (name.rfind("node", 0) != 0 || name.size() == 4 || !std::isdigit(name[4])) {
+            continue;
+        }
+
+        numa_node node{ std::stoul(name.substr(4)), {}, 0 };
+
+        std::ifstream cpulist(entry.path() / "cpulist");
+        std::string list;
+        std::getline(cpulist, list);
+        node.cpus = parse_cpu_list(list);
+
+        // Lines are of the form "Node 0 MemTotal:       65765432 kB".
+        std::ifstream meminfo(entry.path() / "meminfo");
+        std::string line;
+        while (std::getline(meminfo, line)) {
+            auto pos = line.find("MemTotal:");
+            if (pos != std::string::npos) {
+                node.memory_mb = std::stoul(line.substr(pos + 9)) / 1024;
+                break;
+            }
+        }
+
+        if (!node.cpus.empty()) {
+            nodes.push_back(node);
+        }
+    }
+
+    std::sort(nodes.begin(), nodes.end(), [](auto const& a, auto const& b) { return a.id < b.id; });
+    return nodes;
+}
+
+inline void print_topology(std::vector<numa_node> const& nodes)
+{
+    info("NUMA nodes detected: ", nodes.size());
+    for (auto const& node : nodes) {
+        info("  node ", node.id, ": ", node.cpus.size(), " cpus, ", node.memory_mb, "MB");
+    }
+}
+
+/**
+ * Selects the node this process should bind to.
+ * - "auto": Take the first node whose lock file we can exclusively lock. The lock is held for the lifetime of the
+ *   process, so concurrently running rollup_cli instances spread themselves across the nodes. If every node is taken,
+ *   fall back to distributing by pid.
+ * - "<n>": Use node n.
+ * Returns -1 if no valid node could be selected, including if the mode is neither.
+ */
+inline int select_node(std::string const& mode, std::vector<numa_node> const& nodes)
+{
+    if (nodes.empty()) {
+        return -1;
+    }
+
+    if (mode != "auto") {
+        if (mode.empty() || mode.size() > 9 || mode.find_first_not_of("0123456789") != std::string::npos) {
+            info("Invalid NUMA mode: ", mode);
+            return -1;
+        }
+        auto id = std::stoul(mode);
+        for (size_t i = 0; i < nodes.size(); ++i) {
+            if (nodes[i].id == id) {
+                return static_cast<int>(i);
+            }
+        }
+        info("NUMA node ", id, " not found.");
+        return -1;
+    }
+
+#ifdef __linux__
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        auto lock_path = format("/tmp/rollup_cli_numa_node_", nodes[i].id, ".lock");
+        int fd = open(lock_path.c_str(), O_CREAT | O_RDWR, 0666);
+        if (fd < 0) {
+            continue;
+        }
+        if (flock(fd, LOCK_EX | LOCK_NB) == 0) {
+            // Intentionally leak the fd, the lock is released when the process exits.
+            return static_cast<int>(i);
+        }
+        close(fd);
+    }
+    return static_cast<int>(static_cast<size_t>(getpid()) % nodes.size());
+#else
+    return 0;
+#endif
+}
+
+/**
+ * Pins this process (and any threads it subsequently spawns, including the OpenMP worker pool) to the cpus of the
+ * given node, and has all future memory allocations prefer that node. Must be called before the proving keys are
+ * loaded or computed, so their pages are first touched on the local node.
+ *
+ * Allocations spill to other nodes once the node is full. With `strict`, they're bound to the node instead, so a proof
+ * that needs more than the node's memory fails rather than running with remote memory.
+ */
+inline bool bind_to_node(numa_node const& node, bool strict = false)
+{
+#ifdef __linux__
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    size_t num_cpus = 0;
+    for (auto cpu : node.cpus) {
+        // A fixed size cpu_set_t only holds the first CPU_SETSIZE cpus.
+        if (cpu >= CPU_SETSIZE) {
+            info("Skipping cpu ", cpu, " of NUMA node ", node.id, ", beyond the ", CPU_SETSIZE, " a cpu set holds.");
+            continue;
+        }
+        CPU_SET(cpu, &cpu_set);
+        ++num_cpus;
+    }
+    if (num_cpus == 0) {
+        info("No cpus of NUMA node ", node.id, " can be bound to.");
+        return false;
+    }
+    if (sched_setaffinity(0, sizeof(cpu_set), &cpu_set) != 0) {
+        info("Failed to set cpu affinity for NUMA node ", node.id);
+        return false;
+    }
+
+    // MPOL_PREFERRED and MPOL_BIND from <numaif.h>. We call the syscall directly to avoid a dependency on libnuma.
+    constexpr int MPOL_PREFERRED = 1;
+    constexpr int MPOL_BIND = 2;
+    constexpr size_t BITS_PER_MASK = sizeof(unsigned long) * 8;
+    std::vector<unsigned long> node_mask(node.id / BITS_PER_MASK + 1, 0);
+    node_mask[node.id / BITS_PER_MASK] = 1UL << (node.id % BITS_PER_MASK);
+    auto policy = strict ? MPOL_BIND : MPOL_PREFERRED;
+    if (syscall(SYS_set_mempolicy, policy, node_mask.data(), node_mask.size() * BITS_PER_MASK + 1) != 0) {
+        info("Failed to set memory policy for NUMA node ", node.id);
+        return false;
+    }
+
+#ifndef NO_MULTITHREADING
+    omp_set_num_threads(static_cast<int>(num_cpus));
+#endif
+    return true;
+#else
+    info("NUMA binding is only supported on linux.");
+    return false;
+#endif
+}
+
+} // namespace numa
+} // namespace rollup
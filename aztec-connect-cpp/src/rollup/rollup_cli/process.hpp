@@ -0,0 +1,151 @@
+#pragma once
+#include <common/throw_or_abort.hpp>
+#include <iostream>
+#include <memory>
+#include <streambuf>
+#include <string>
+#include <vector>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace rollup {
+namespace process {
+
+/**
+ * A buffered stream buffer over one end of a pipe.
+ */
+class FdBuffer : public std::streambuf {
+  public:
+    explicit FdBuffer(int fd)
+        : fd_(fd)
+        , buffer_(1 << 16)
+    {
+        setg(buffer_.data(), buffer_.data(), buffer_.data());
+        setp(buffer_.data(), buffer_.data() + buffer_.size());
+    }
+
+  protected:
+    int_type underflow() override
+    {
+        auto count = ::read(fd_, buffer_.data(), buffer_.size());
+        if (count <= 0) {
+            return traits_type::eof();
+        }
+        setg(buffer_.data(), buffer_.data(), buffer_.data() + count);
+        return traits_type::to_int_type(*gptr());
+    }
+
+    int_type overflow(int_type c) override
+    {
+        if (sync() != 0) {
+            return traits_type::eof();
+        }
+        if (!traits_type::eq_int_type(c, traits_type::eof())) {
+            *pptr() = traits_type::to_char_type(c);
+            pbump(1);
+        }
+        return traits_type::not_eof(c);
+    }
+
+    int sync() override
+    {
+        auto data = pbase();
+        while (data < pptr()) {
+            auto written = ::write(fd_, data, static_cast<size_t>(pptr() - data));
+            if (written <= 0) {
+                return -1;
+            }
+            data += written;
+        }
+        setp(buffer_.data(), buffer_.data() + buffer_.size());
+        return 0;
+    }
+
+  private:
+    int fd_;
+    std::vector<char> buffer_;
+};
+
+/**
+ * A child process speaking the stdin/stdout protocol of rollup_cli or db_cli. Its stderr is left as ours, so its logs
+ * are interleaved with ours.
+ */
+class Process {
+  public:
+    /**
+     * Starts the executable at `args[0]` with the rest as its arguments.
+     */
+    explicit Process(std::vector<std::string> const& args)
+    {
+        int to_child[2];
+        int from_child[2];
+        if (pipe(to_child) || pipe(from_child)) {
+            throw_or_abort("Failed to create pipes.");
+        }
+        pid_ = fork();
+        if (pid_ == 0) {
+            dup2(to_child[0], STDIN_FILENO);
+            dup2(from_child[1], STDOUT_FILENO);
+            close(to_child[0]);
+            close(to_child[1]);
+            close(from_child[0]);
+            close(from_child[1]);
+            std::vector<char*> argv;
+            for (auto const& arg : args) {
+                argv.push_back(const_cast<char*>(arg.c_str()));
+            }
+            argv.push_back(nullptr);
+            execv(argv[0], argv.data());
+            std::cerr << "Failed to exec " << args[0] << std::endl;
+            _exit(1);
+        }
+        close(to_child[0]);
+        close(from_child[1]);
+        input_fd_ = to_child[1];
+        output_fd_ = from_child[0];
+        input_buffer_ = std::make_unique<FdBuffer>(input_fd_);
+        output_buffer_ = std::make_unique<FdBuffer>(output_fd_);
+        input_ = std::make_unique<std::ostream>(input_buffer_.get());
+        output_ = std::make_unique<std::istream>(output_buffer_.get());
+    }
+
+    Process(Process const&) = delete;
+    Process& operator=(Process const&) = delete;
+
+    ~Process() { wait(); }
+
+    // The child's standard input. Flush once a request is written.
+    std::ostream& input() { return *input_; }
+
+    // The child's standard output.
+    std::istream& output() { return *output_; }
+
+    /**
+     * Closes the child's standard input, so it exits once done, and waits for it to. Returns its exit status.
+     */
+    int wait()
+    {
+        if (pid_ <= 0) {
+            return status_;
+        }
+        input_->flush();
+        close(input_fd_);
+        waitpid(pid_, &status_, 0);
+        close(output_fd_);
+        pid_ = 0;
+        return status_;
+    }
+
+  private:
+    pid_t pid_ = 0;
+    int status_ = 0;
+    int input_fd_ = -1;
+    int output_fd_ = -1;
+    std::unique_ptr<FdBuffer> input_buffer_;
+    std::unique_ptr<FdBuffer> output_buffer_;
+    std::unique_ptr<std::ostream> input_;
+    std::unique_ptr<std::istream> output_;
+};
+
+} // namespace process
+} // namespace rollup
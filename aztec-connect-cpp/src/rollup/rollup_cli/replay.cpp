@@ -0,0 +1,152 @@
+#include "capture.hpp"
+#include "latency.hpp"
+#include "process.hpp"
+#include "requests.hpp"
+#include <common/log.hpp>
+#include <common/serialize.hpp>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace rollup;
+using clock_type = std::chrono::steady_clock;
+
+namespace {
+
+void send(std::ostream& os, uint32_t proof_id, std::vector<uint8_t> const& body)
+{
+    serialize::write(os, proof_id);
+    os.write(reinterpret_cast<char const*>(body.data()), static_cast<std::streamsize>(body.size()));
+    os.flush();
+}
+
+/**
+ * Reads and discards rollup_cli's response to a request, in the format its main loop writes it.
+ */
+void read_response(std::istream& is, uint32_t proof_id, std::vector<uint8_t> const& body = {})
+{
+    std::vector<uint8_t> buf;
+    bool flag;
+    switch (proof_id) {
+    case requests::TX_ROLLUP:
+    case requests::ROOT_ROLLUP:
+    case requests::CLAIM:
+    case requests::ROOT_VERIFIER:
+    case requests::ACCOUNT:
+    case requests::ROOT_ROLLUP_BY_REFERENCE:
+    case requests::ROOT_VERIFIER_BY_REFERENCE:
+    case requests::TX_ROLLUP_SIZED:
+        // Proof data, then whether it verified.
+        serialize::read(is, buf);
+        serialize::read(is, flag);
+        break;
+    case requests::JOIN_SPLIT_VK:
+    case requests::ACCOUNT_VK:
+    case requests::STATS:
+        serialize::read(is, buf);
+        break;
+    case requests::BLOCK: {
+        // A response per tx rollup, then the root rollup's and the root verifier's, stopping at the first that fails.
+        // The body starts with the vector of tx rollups, so their number.
+        uint32_t num_tx_rollups = 0;
+        if (body.size() >= sizeof(num_tx_rollups)) {
+            auto it = body.data();
+            serialize::read(it, num_tx_rollups);
+        }
+        flag = true;
+        for (uint32_t i = 0; i < num_tx_rollups + 2 && flag && is.good(); ++i) {
+            serialize::read(is, buf);
+            serialize::read(is, flag);
+        }
+        break;
+    }
+    case requests::PING:
+        serialize::read(is, flag);
+        break;
+    default:
+        // Unknown commands aren't responded to.
+        break;
+    }
+    if (!is.good()) {
+        throw_or_abort("rollup_cli exited before responding.");
+    }
+}
+
+} // namespace
+
+/**
+ * Replays a capture recorded by rollup_cli against a fresh rollup_cli, at the pacing the requests originally arrived
+ * at divided by `speed`, or as fast as possible if `speed` is 0. Reports the distribution of latencies, in seconds,
+ * from each request being sent to its response, per request type, alongside those of the original run.
+ *
+ * Requests are sent on their schedule regardless of responses, so replayed latencies include time queued behind
+ * earlier requests. Captured latencies are from rollup_cli reading a request to responding, so exclude it.
+ */
+int main(int argc, char** argv)
+{
+    std::vector<std::string> args(argv, argv + argc);
+    if (args.size() < 4) {
+        std::cerr << "usage: " << args[0] << " <capture> <speed (0 = as fast as possible)> <rollup_cli path> "
+                  << "[rollup_cli args...]" << std::endl;
+        return 1;
+    }
+    auto records = capture::read_capture(args[1]);
+    auto speed = std::stod(args[2]);
+    info("Replaying ", records.size(), " requests from ", args[1], " at ", speed ? std::to_string(speed) : "max",
+         " speed.");
+
+    process::Process rollup_cli(std::vector<std::string>(args.begin() + 3, args.end()));
+    auto& in = rollup_cli.input();
+    auto& out = rollup_cli.output();
+
+    // Wait for rollup_cli to finish loading keys, so start up isn't counted against the first request.
+    send(in, requests::PING, {});
+    read_response(out, requests::PING);
+    info("rollup_cli is ready.");
+
+    // Microseconds from the start to each request being sent.
+    std::vector<std::atomic<uint64_t>> sent(records.size());
+    auto start = clock_type::now();
+    auto since_start = [&]() {
+        auto elapsed = clock_type::now() - start;
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count());
+    };
+    std::thread sender([&]() {
+        for (size_t i = 0; i < records.size(); ++i) {
+            if (speed > 0) {
+                std::this_thread::sleep_until(
+                    start + std::chrono::microseconds(static_cast<uint64_t>(double(records[i].arrival) / speed)));
+            }
+            sent[i] = since_start();
+            send(in, records[i].proof_id, records[i].body);
+        }
+    });
+
+    std::map<std::string, std::vector<double>> replayed;
+    std::map<std::string, std::vector<double>> captured;
+    for (size_t i = 0; i < records.size(); ++i) {
+        auto const& record = records[i];
+        read_response(out, record.proof_id, record.body);
+        auto received = since_start();
+        // The sender sets `sent[i]` before writing the request, so it's set by the time its response arrives.
+        std::string name = requests::name(record.proof_id);
+        replayed[name].push_back(static_cast<double>(received - sent[i]) / 1e6);
+        captured[name].push_back(static_cast<double>(record.duration) / 1e6);
+    }
+    sender.join();
+    auto elapsed = std::chrono::duration<double>(clock_type::now() - start).count();
+    rollup_cli.wait();
+
+    latency::print_header(std::cout);
+    for (auto const& [name, latencies] : replayed) {
+        latency::print_row(std::cout, name, "replayed", latencies);
+        latency::print_row(std::cout, name, "captured", captured[name]);
+    }
+    info("Replayed ", records.size(), " requests in ", elapsed, "s.");
+
+    return 0;
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include <cstdint>
+
+namespace rollup {
+namespace requests {
+
+/**
+ * The ids of the requests rollup_cli reads off stdin, each a big endian uint32 followed by its body.
+ */
+enum Id : uint32_t {
+    TX_ROLLUP = 0,
+    ROOT_ROLLUP = 1,
+    CLAIM = 2,
+    ROOT_VERIFIER = 3,
+    ACCOUNT = 4,
+    // As ROOT_ROLLUP and ROOT_VERIFIER, referring to proofs rollup_cli returned by their hash.
+    ROOT_ROLLUP_BY_REFERENCE = 5,
+    ROOT_VERIFIER_BY_REFERENCE = 6,
+    BLOCK = 7,
+    TX_ROLLUP_SIZED = 8,
+    JOIN_SPLIT_VK = 100,
+    ACCOUNT_VK = 101,
+    STATS = 102,
+    PING = 666,
+};
+
+inline char const* name(uint32_t id)
+{
+    switch (id) {
+    case TX_ROLLUP:
+        return "tx_rollup";
+    case ROOT_ROLLUP:
+        return "root_rollup";
+    case CLAIM:
+        return "claim";
+    case ROOT_VERIFIER:
+        return "root_verifier";
+    case ACCOUNT:
+        return "account";
+    case ROOT_ROLLUP_BY_REFERENCE:
+        return "root_rollup_by_ref";
+    case ROOT_VERIFIER_BY_REFERENCE:
+        return "root_verifier_by_ref";
+    case BLOCK:
+        return "block";
+    case TX_ROLLUP_SIZED:
+        return "tx_rollup_sized";
+    case JOIN_SPLIT_VK:
+        return "join_split_vk";
+    case ACCOUNT_VK:
+        return "account_vk";
+    case STATS:
+        return "stats";
+    case PING:
+        return "ping";
+    default:
+        return "unknown";
+    }
+}
+
+} // namespace requests
+} // namespace rollup
@@ -0,0 +1,85 @@
+#pragma once
+#include <algorithm>
+#include <iostream>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace rollup {
+namespace sizes {
+
+/**
+ * Parses a non negative integer argument, or returns nothing if it isn't one.
+ */
+inline std::optional<size_t> parse_count(std::string const& arg)
+{
+    if (arg.empty() || arg.size() > 18 || arg.find_first_not_of("0123456789") != std::string::npos) {
+        return std::nullopt;
+    }
+    return std::stoul(arg);
+}
+
+/**
+ * Parses a comma separated list of circuit sizes, e.g. `1,4,32`, into ascending order. Returns an empty list, having
+ * reported why, if any size isn't a positive integer.
+ */
+inline std::vector<size_t> parse(std::string const& list)
+{
+    std::vector<size_t> sizes;
+    std::istringstream is(list);
+    std::string size;
+    while (std::getline(is, size, ',')) {
+        auto parsed = parse_count(size);
+        if (!parsed || *parsed == 0) {
+            std::cerr << "Circuit sizes must be a comma separated list of positive integers, not: " << list
+                      << std::endl;
+            return {};
+        }
+        sizes.push_back(*parsed);
+    }
+    // getline doesn't yield a trailing empty entry.
+    if (sizes.empty() || list.back() == ',') {
+        std::cerr << "Circuit sizes must be a comma separated list of positive integers, not: " << list << std::endl;
+        return {};
+    }
+    std::sort(sizes.begin(), sizes.end());
+    sizes.erase(std::unique(sizes.begin(), sizes.end()), sizes.end());
+    return sizes;
+}
+
+inline std::string to_string(std::vector<size_t> const& sizes)
+{
+    std::ostringstream os;
+    for (size_t i = 0; i < sizes.size(); ++i) {
+        os << (i ? "," : "") << sizes[i];
+    }
+    return os.str();
+}
+
+/**
+ * The smallest of the ascending sizes that's at least `needed`.
+ */
+inline std::optional<size_t> smallest_fitting(std::vector<size_t> const& sizes, size_t needed)
+{
+    auto it = std::lower_bound(sizes.begin(), sizes.end(), needed);
+    if (it == sizes.end()) {
+        return std::nullopt;
+    }
+    return *it;
+}
+
+/**
+ * The next power of 2 at or above `size`, which circuits are padded to.
+ */
+inline size_t pow2(size_t size)
+{
+    size_t result = 1;
+    while (result < size) {
+        result <<= 1;
+    }
+    return result;
+}
+
+} // namespace sizes
+} // namespace rollup
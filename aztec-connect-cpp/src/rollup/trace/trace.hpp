@@ -0,0 +1,241 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#ifndef NO_MULTITHREADING
+#include <mutex>
+#endif
+
+namespace rollup {
+namespace trace {
+
+struct Event {
+    char const* name;
+    char const* category;
+    std::string detail;
+    // Microseconds since the tracer was created.
+    uint64_t start;
+    uint64_t duration;
+    uint32_t thread_id;
+};
+
+/**
+ * A small id for the calling thread, numbered in order of first use, so the timeline's rows are readable.
+ */
+inline uint32_t thread_id()
+{
+#ifndef NO_MULTITHREADING
+    static std::atomic<uint32_t> next_id = 0;
+    thread_local uint32_t id = next_id++;
+    return id;
+#else
+    return 0;
+#endif
+}
+
+inline std::string escape(std::string const& str)
+{
+    std::string escaped;
+    for (auto c : str) {
+        if (c == '"' || c == '\\') {
+            escaped += '\\';
+        }
+        escaped += c == '\n' ? ' ' : c;
+    }
+    return escaped;
+}
+
+/**
+ * Records spans of the request being traced, and writes them out as a Chrome trace (load in chrome://tracing or
+ * Perfetto) once it's done.
+ *
+ * Tracing is off until `configure` is given an output directory. Even then only one in `sample_every` requests is
+ * traced, and outside a traced request a span costs one atomic load, so tracing can be left on in production.
+ */
+class Tracer {
+  public:
+    Tracer()
+        : epoch_(std::chrono::steady_clock::now())
+    {}
+
+    void configure(std::string const& output_dir, size_t sample_every)
+    {
+        output_dir_ = output_dir;
+        sample_every_ = sample_every ? sample_every : 1;
+    }
+
+    bool recording() const { return recording_.load(std::memory_order_relaxed); }
+
+    uint64_t now() const
+    {
+        auto elapsed = std::chrono::steady_clock::now() - epoch_;
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count());
+    }
+
+    /**
+     * Starts recording spans if tracing is on and this request is sampled. Requests aren't nested: returns false if
+     * one is already being recorded.
+     */
+    bool begin_request()
+    {
+        if (output_dir_.empty() || recording() || requests_++ % sample_every_ != 0) {
+            return false;
+        }
+        auto lock = lock_events();
+        events_.clear();
+        recording_ = true;
+        return true;
+    }
+
+    /**
+     * Stops recording and writes the request's spans to `<output dir>/<name>-<request number>.json`.
+     */
+    void end_request(std::string const& name)
+    {
+        recording_ = false;
+        auto lock = lock_events();
+        auto request = requests_ - 1;
+        auto path = output_dir_ + "/" + name + "-" + std::to_string(request) + ".json";
+        std::ofstream file(path);
+        write(file, request);
+        if (!file.good()) {
+            std::cerr << "Failed to write trace to " << path << std::endl;
+        }
+        events_.clear();
+    }
+
+    void record(Event&& event)
+    {
+        auto lock = lock_events();
+        events_.push_back(std::move(event));
+    }
+
+  private:
+#ifndef NO_MULTITHREADING
+    std::lock_guard<std::mutex> lock_events() { return std::lock_guard<std::mutex>(mutex_); }
+#else
+    struct NoLock {
+        ~NoLock() {}
+    };
+    NoLock lock_events() { return {}; }
+#endif
+
+    // The request number stands in for the process id, so traces of several requests can be loaded together.
+    void write(std::ostream& os, size_t request) const
+    {
+        os << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+        for (size_t i = 0; i < events_.size(); ++i) {
+            auto const& event = events_[i];
+            os << (i ? ",\n" : "\n") << "{\"name\":\"" << event.name << "\",\"cat\":\"" << event.category
+               << "\",\"ph\":\"X\",\"ts\":" << event.start << ",\"dur\":" << event.duration << ",\"pid\":" << request
+               << ",\"tid\":" << event.thread_id;
+            if (!event.detail.empty()) {
+                os << ",\"args\":{\"detail\":\"" << escape(event.detail) << "\"}";
+            }
+            os << "}";
+        }
+        os << "\n]}\n";
+    }
+
+    std::chrono::steady_clock::time_point epoch_;
+    std::string output_dir_;
+    size_t sample_every_ = 1;
+    size_t requests_ = 0;
+    std::atomic<bool> recording_ = false;
+#ifndef NO_MULTITHREADING
+    std::mutex mutex_;
+#endif
+    std::vector<Event> events_;
+};
+
+inline Tracer& tracer()
+{
+    static Tracer tracer;
+    return tracer;
+}
+
+/**
+ * Records the time from its construction to its destruction, or to `stop`, as a span of the traced request. Spans on
+ * a thread nest by time, so are shown nested without tracking their parents.
+ */
+class Span {
+  public:
+    Span(char const* name, char const* category, std::string const& detail = "")
+        : name_(name)
+        , category_(category)
+        , recording_(tracer().recording())
+    {
+        if (recording_) {
+            detail_ = detail;
+            start_ = tracer().now();
+        }
+    }
+
+    /**
+     * A span detailed by a prefix and an index, e.g. "tx 3", which is only formatted if the span is recorded.
+     */
+    Span(char const* name, char const* category, char const* prefix, size_t index)
+        : Span(name, category)
+    {
+        if (recording_) {
+            detail_ = std::string(prefix) + " " + std::to_string(index);
+        }
+    }
+
+    Span(Span const&) = delete;
+    Span& operator=(Span const&) = delete;
+
+    ~Span() { stop(); }
+
+    void stop()
+    {
+        if (!recording_) {
+            return;
+        }
+        recording_ = false;
+        auto& t = tracer();
+        t.record({ name_, category_, std::move(detail_), start_, t.now() - start_, thread_id() });
+    }
+
+  private:
+    char const* name_;
+    char const* category_;
+    bool recording_;
+    std::string detail_;
+    uint64_t start_ = 0;
+};
+
+/**
+ * Traces a request, if it's sampled, from its construction to its destruction. The request itself is the outermost
+ * span.
+ */
+class Request {
+  public:
+    explicit Request(char const* name)
+        : name_(name)
+        , traced_(tracer().begin_request())
+        , span_(name, "request")
+    {}
+
+    Request(Request const&) = delete;
+    Request& operator=(Request const&) = delete;
+
+    ~Request()
+    {
+        if (traced_) {
+            span_.stop();
+            tracer().end_request(name_);
+        }
+    }
+
+  private:
+    char const* name_;
+    bool traced_;
+    Span span_;
+};
+
+} // namespace trace
+} // namespace rollup
@@ -0,0 +1,614 @@
+#include "tx_mix.hpp"
+#include "../proofs/mock/mock_circuit.hpp"
+#include "../proofs/rollup/index.hpp"
+#include "../proofs/root_rollup/index.hpp"
+#include "../fixtures/test_context.hpp"
+#include "../db_cli/command.hpp"
+#include "../db_cli/put.hpp"
+#include "../rollup_cli/artifact_cache.hpp"
+#include "../rollup_cli/latency.hpp"
+#include "../rollup_cli/process.hpp"
+#include "../rollup_cli/requests.hpp"
+#include <common/log.hpp>
+#include <common/throw_or_abort.hpp>
+#include <common/timer.hpp>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <thread>
+
+using namespace ::rollup::proofs;
+using namespace ::rollup::tx_factory;
+using ::rollup::NUM_INTERACTION_RESULTS_PER_BLOCK;
+using namespace plonk::stdlib::types::turbo;
+namespace tx_rollup = ::rollup::proofs::rollup;
+namespace requests = ::rollup::requests;
+using clock_type = std::chrono::steady_clock;
+
+namespace {
+
+const std::string CRS_PATH = "../barretenberg/cpp/srs_db/ignition";
+
+std::vector<uint8_t> artifact_ref(std::vector<uint8_t> const& artifact)
+{
+    auto hash = ::rollup::artifact_cache::hash(artifact);
+    return { hash.begin(), hash.end() };
+}
+
+/**
+ * Proving keys of the client circuits. Each proving thread has its own, as a prover writes to its key.
+ */
+struct ClientKeys {
+    join_split::circuit_data js;
+    account::circuit_data account;
+    claim::circuit_data claim;
+};
+
+using ProofJob = std::function<std::vector<uint8_t>(ClientKeys const&)>;
+
+/**
+ * Proves the circuit built by `build_circuit`, or a mock circuit with its public inputs if the keys are mock ones.
+ */
+template <typename F> std::vector<uint8_t> prove(::rollup::proofs::circuit_data const& cd, F const& build_circuit)
+{
+    Composer composer(cd.proving_key, cd.verification_key, cd.num_gates);
+    build_circuit(composer);
+    if (composer.failed) {
+        throw_or_abort("Client circuit logic failed: " + composer.err);
+    }
+    if (!cd.mock) {
+        auto prover = composer.create_unrolled_prover();
+        return prover.construct_proof().proof_data;
+    }
+    Composer mock_composer(cd.proving_key, cd.verification_key, cd.num_gates);
+    mock::mock_circuit(mock_composer, composer.get_public_inputs());
+    auto prover = mock_composer.create_unrolled_prover();
+    return prover.construct_proof().proof_data;
+}
+
+/**
+ * Runs the jobs across a thread per set of keys.
+ */
+std::vector<std::vector<uint8_t>> prove_all(std::vector<ProofJob> const& jobs, std::vector<ClientKeys> const& keys)
+{
+    std::vector<std::vector<uint8_t>> proofs(jobs.size());
+    std::atomic<size_t> next = 0;
+    std::vector<std::thread> threads;
+    for (size_t k = 0; k < keys.size(); ++k) {
+        threads.emplace_back([&, k]() {
+            for (size_t i = next++; i < jobs.size(); i = next++) {
+                proofs[i] = jobs[i](keys[k]);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    return proofs;
+}
+
+/**
+ * A block's requests to rollup_cli. The root rollup is missing its inner rollup proofs, which it's given as they're
+ * proven.
+ */
+struct Block {
+    std::vector<tx_rollup::rollup_tx> tx_rollups;
+    root_rollup::root_rollup_tx root_rollup;
+    std::vector<notes::native::defi_interaction::note> interaction_notes;
+    std::map<TxType, size_t> tx_counts;
+};
+
+/**
+ * Builds blocks of client txs of the mix from the test fixtures' user, as a busy rollup provider would see them.
+ *
+ * Before each block, the notes its txs spend are added to the world state as though from earlier blocks: value notes
+ * for sends, withdrawals, defi deposits and chains, account notes for account txs, and claim notes with a defi
+ * interaction result for claims. The client proofs are then proven in parallel, and the tx rollups and root rollup
+ * built over them, updating the world state as rollup providers do.
+ */
+class BlockFactory {
+  public:
+    BlockFactory(ClientKeys const& keys,
+                 std::vector<ClientKeys> const& prover_keys,
+                 TxMix const& mix,
+                 uint32_t txs_per_inner,
+                 uint32_t inners_per_root)
+        : context_(keys.js, keys.account, keys.claim)
+        , prover_keys_(prover_keys)
+        , mix_(mix)
+        , txs_per_inner_(txs_per_inner)
+        , inners_per_root_(inners_per_root)
+        , engine_(1)
+    {}
+
+    Block create_block()
+    {
+        Block block;
+        std::vector<std::vector<TxType>> inner_types(inners_per_root_);
+        for (auto& types : inner_types) {
+            while (types.size() < txs_per_inner_) {
+                auto type = mix_.draw(engine_, types.size() + 1 < txs_per_inner_);
+                types.push_back(type);
+                if (type == CHAIN) {
+                    types.push_back(CHAIN);
+                }
+                ++block.tx_counts[type];
+            }
+        }
+
+        // Add the notes the txs spend to the world state, then start the block, so they're in its data root.
+        auto& world_state = context_.world_state;
+        auto rollup_id = static_cast<uint32_t>(world_state.root_tree.size());
+        auto& counts = block.tx_counts;
+        for (auto type : { SEND, WITHDRAW, DEFI_DEPOSIT, CHAIN }) {
+            for (size_t i = 0; i < counts[type]; ++i) {
+                value_notes_.push_back(static_cast<uint32_t>(world_state.data_tree.size()));
+                context_.append_value_notes({ 100, 50 });
+            }
+        }
+        auto account_note_index = static_cast<uint32_t>(world_state.data_tree.size());
+        if (counts[ACCOUNT]) {
+            context_.append_account_notes();
+        }
+        auto claim_notes = seed_claim_notes(block.tx_counts[CLAIM], rollup_id);
+        auto old_defi_root = world_state.defi_tree.root();
+        auto old_defi_path = world_state.defi_tree.get_hash_path(rollup_id * NUM_INTERACTION_RESULTS_PER_BLOCK);
+        std::vector<notes::native::defi_interaction::note> dins;
+        if (!claim_notes.empty()) {
+            dins.push_back({ bridge_call_data(), 0, 1000, 2000, 3000, true });
+        }
+        auto din_index = context_.start_next_root_rollup(dins);
+        for (size_t i = 0; i < dins.size(); ++i) {
+            block.interaction_notes.push_back(context_.defi_interactions[din_index + i]);
+        }
+
+        std::vector<ProofJob> jobs;
+        for (auto const& types : inner_types) {
+            for (size_t i = 0; i < types.size(); ++i) {
+                switch (types[i]) {
+                case CHAIN:
+                    add_chain_jobs(jobs);
+                    ++i;
+                    break;
+                case CLAIM:
+                    add_claim_job(jobs, claim_notes.back(), din_index);
+                    claim_notes.pop_back();
+                    break;
+                case ACCOUNT:
+                    add_account_job(jobs, account_note_index);
+                    break;
+                default:
+                    add_join_split_job(jobs, types[i]);
+                    break;
+                }
+            }
+        }
+        auto proofs = prove_all(jobs, prover_keys_);
+
+        // Tx rollups with defi deposits or claims list the bridge, as does the root rollup if any do.
+        std::vector<uint256_t> bridge_call_datas;
+        size_t next_proof = 0;
+        for (auto const& types : inner_types) {
+            std::vector<std::vector<uint8_t>> txs;
+            std::vector<uint256_t> inner_bridge_call_datas;
+            for (auto type : types) {
+                txs.push_back(std::move(proofs[next_proof++]));
+                if ((type == DEFI_DEPOSIT || type == CLAIM) && inner_bridge_call_datas.empty()) {
+                    inner_bridge_call_datas.push_back(bridge_call_data());
+                    bridge_call_datas = inner_bridge_call_datas;
+                }
+            }
+            block.tx_rollups.push_back(
+                tx_rollup::create_rollup_tx(world_state, txs_per_inner_, txs, inner_bridge_call_datas));
+        }
+        block.root_rollup = root_rollup::create_root_rollup_tx(world_state,
+                                                               rollup_id,
+                                                               old_defi_root,
+                                                               old_defi_path,
+                                                               std::vector<std::vector<uint8_t>>(inners_per_root_),
+                                                               bridge_call_datas,
+                                                               { 0 },
+                                                               block.interaction_notes);
+        return block;
+    }
+
+  private:
+    static notes::native::bridge_call_data bridge_call_data()
+    {
+        return { .bridge_address_id = 0,
+                 .input_asset_id_a = 0,
+                 .input_asset_id_b = 0,
+                 .output_asset_id_a = 111,
+                 .output_asset_id_b = 222,
+                 .config = notes::native::bridge_call_data::bit_config{ .second_input_in_use = false,
+                                                                        .second_output_in_use = true },
+                 .aux_data = 0 };
+    }
+
+    // Returns the indices of the next unspent pair of value notes of 100 and 50.
+    std::array<uint32_t, 2> take_value_notes()
+    {
+        auto index = value_notes_.front();
+        value_notes_.pop_front();
+        return { index, index + 1 };
+    }
+
+    // Adds claim notes for the defi interaction the block's first interaction note will be the result of.
+    std::vector<uint32_t> seed_claim_notes(size_t count, uint32_t rollup_id)
+    {
+        auto& user = context_.user;
+        std::vector<uint32_t> indices;
+        for (size_t i = 0; i < count; ++i) {
+            auto index = static_cast<uint32_t>(context_.world_state.data_tree.size());
+            notes::native::claim::claim_note note = {
+                .deposit_value = 10,
+                .bridge_call_data = bridge_call_data(),
+                .defi_interaction_nonce = (rollup_id - 1) * NUM_INTERACTION_RESULTS_PER_BLOCK,
+                .fee = 0,
+                .value_note_partial_commitment =
+                    notes::native::value::create_partial_commitment(user.note_secret, user.owner.public_key, 0, 0),
+                .input_nullifier = fr(index),
+            };
+            context_.world_state.append_data_note(note);
+            indices.push_back(index);
+        }
+        return indices;
+    }
+
+    void add_join_split_job(std::vector<ProofJob>& jobs, TxType type)
+    {
+        auto& factory = context_.js_tx_factory;
+        join_split::join_split_tx tx;
+        switch (type) {
+        case DEPOSIT:
+            tx = factory.create_join_split_tx({}, {}, { 100, 30 }, 130);
+            break;
+        case WITHDRAW: {
+            auto in = take_value_notes();
+            tx = factory.create_join_split_tx({ in[0], in[1] }, { 100, 50 }, { 70, 30 }, 0, 50);
+            break;
+        }
+        case DEFI_DEPOSIT: {
+            auto in = take_value_notes();
+            tx = factory.create_defi_deposit_tx({ in[0], in[1] }, { 100, 50 }, { 40, 110 }, bridge_call_data());
+            break;
+        }
+        default: {
+            auto in = take_value_notes();
+            tx = factory.create_join_split_tx({ in[0], in[1] }, { 100, 50 }, { 70, 80 });
+            break;
+        }
+        }
+        factory.finalise_and_sign_tx(tx, context_.user.owner);
+        jobs.push_back(join_split_job(tx));
+    }
+
+    // A send, then a send spending its first output and another note, in the same tx rollup.
+    void add_chain_jobs(std::vector<ProofJob>& jobs)
+    {
+        auto& factory = context_.js_tx_factory;
+        auto in = take_value_notes();
+        auto tx1 = factory.create_join_split_tx({ in[0] }, { 100 }, { 70, 30 });
+        tx1.allow_chain = 1;
+        factory.finalise_and_sign_tx(tx1, context_.user.owner);
+        auto tx2 = factory.create_join_split_tx({ in[0], in[1] }, { 70, 50 }, { 120, 0 });
+        tx2.input_note[0] = tx1.output_note[0];
+        tx2.backward_link = tx2.input_note[0].commit();
+        factory.finalise_and_sign_tx(tx2, context_.user.owner);
+        jobs.push_back(join_split_job(tx1));
+        jobs.push_back(join_split_job(tx2));
+    }
+
+    void add_account_job(std::vector<ProofJob>& jobs, uint32_t account_note_index)
+    {
+        auto& keys = context_.extra_key_pairs;
+        grumpkin::g1::affine_element new_signing_keys[2] = { keys[0].public_key, keys[1].public_key };
+        auto tx = context_.account_tx_factory.create_add_signing_keys_to_account_tx(new_signing_keys,
+                                                                                    account_note_index);
+        tx.sign(context_.user.signing_keys[0]);
+        jobs.push_back([tx](ClientKeys const& keys) {
+            return prove(keys.account, [&](Composer& composer) { account::account_circuit(composer, tx); });
+        });
+    }
+
+    void add_claim_job(std::vector<ProofJob>& jobs, uint32_t claim_note_index, uint32_t din_index)
+    {
+        auto tx = context_.create_claim_tx(bridge_call_data(), 10, claim_note_index, din_index, 0);
+        jobs.push_back([tx](ClientKeys const& keys) {
+            return prove(keys.claim, [&](Composer& composer) { claim::claim_circuit(composer, tx); });
+        });
+    }
+
+    static ProofJob join_split_job(join_split::join_split_tx const& tx)
+    {
+        return [tx](ClientKeys const& keys) {
+            return prove(keys.js, [&](Composer& composer) { join_split::join_split_circuit(composer, tx); });
+        };
+    }
+
+    ::rollup::fixtures::TestContext context_;
+    std::vector<ClientKeys> const& prover_keys_;
+    TxMix mix_;
+    uint32_t txs_per_inner_;
+    uint32_t inners_per_root_;
+    std::mt19937 engine_;
+    // Indices of the first of each pair of value notes added for the block's txs to spend.
+    std::deque<uint32_t> value_notes_;
+};
+
+/**
+ * Blocks built ahead of rollup_cli, up to a limit.
+ */
+class BlockQueue {
+  public:
+    explicit BlockQueue(size_t capacity)
+        : capacity_(capacity)
+    {}
+
+    void push(Block&& block)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        not_full_.wait(lock, [&] { return blocks_.size() < capacity_; });
+        blocks_.push_back(std::move(block));
+        not_empty_.notify_one();
+    }
+
+    Block pop()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        not_empty_.wait(lock, [&] { return !blocks_.empty(); });
+        auto block = std::move(blocks_.front());
+        blocks_.pop_front();
+        not_full_.notify_one();
+        return block;
+    }
+
+    size_t size()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return blocks_.size();
+    }
+
+  private:
+    size_t capacity_;
+    std::mutex mutex_;
+    std::condition_variable not_full_;
+    std::condition_variable not_empty_;
+    std::deque<Block> blocks_;
+};
+
+void read_db_metadata(std::istream& is)
+{
+    using serialize::read;
+    for (size_t i = 0; i < 4; ++i) {
+        barretenberg::fr root;
+        read(is, root);
+    }
+    for (size_t i = 0; i < 4; ++i) {
+        uint256_t size;
+        read(is, size);
+    }
+    if (!is.good()) {
+        throw_or_abort("db_cli exited before responding.");
+    }
+}
+
+/**
+ * The world state updates a rollup provider makes once a block's proven, from its tx rollups' public inputs.
+ */
+std::vector<PutRequest> world_state_updates(Block const& block, std::vector<std::vector<uint8_t>> const& tx_rollups)
+{
+    std::vector<PutRequest> puts;
+    tx_rollup::rollup_proof_data last;
+    for (auto const& proof : tx_rollups) {
+        tx_rollup::rollup_proof_data data(proof);
+        for (size_t i = 0; i < data.inner_proofs.size(); ++i) {
+            auto const& tx = data.inner_proofs[i];
+            if (tx.proof_id == 0) {
+                continue;
+            }
+            puts.push_back({ DATA_TREE, data.data_start_index + 2 * i, tx.note_commitment1 });
+            puts.push_back({ DATA_TREE, data.data_start_index + 2 * i + 1, tx.note_commitment2 });
+            for (auto nullifier : { tx.nullifier1, tx.nullifier2 }) {
+                if (nullifier) {
+                    puts.push_back({ NULL_TREE, nullifier, barretenberg::fr(1) });
+                }
+            }
+        }
+        last = data;
+    }
+    puts.push_back({ ROOT_TREE, last.rollup_id + 1, last.new_data_root });
+    for (size_t i = 0; i < block.interaction_notes.size(); ++i) {
+        auto index = last.rollup_id * NUM_INTERACTION_RESULTS_PER_BLOCK + i;
+        puts.push_back({ DEFI_TREE, index, block.interaction_notes[i].commit() });
+    }
+    return puts;
+}
+
+} // namespace
+
+/**
+ * Measures the sustained throughput of rollup_cli, and optionally db_cli, under a realistic mix of txs.
+ *
+ * Builds full blocks of client proofs in the given mix in the background, proving them across `workers` threads, and
+ * drives a rollup_cli through each block's tx rollups, root rollup and root verifier as fast as it can. With a db_cli,
+ * each block's world state updates are written and committed to it too, as a rollup provider does. The first
+ * `blocks_ahead` blocks are built before the clock starts, and building is kept at most that far ahead.
+ *
+ * Reports blocks per hour, and the latency distribution of each request and of whole blocks. Time rollup_cli spent
+ * waiting for blocks is reported too: if it's significant, the client provers are the bottleneck, so add workers.
+ */
+int main(int argc, char** argv)
+{
+    std::vector<std::string> args(argv, argv + argc);
+    if (args.size() < 9) {
+        info("usage:\n",
+             args[0],
+             " <num_blocks> <txs_per_inner> <inners_per_root> <mix> <workers> <blocks_ahead> <mock_proofs>"
+             " <rollup_cli path> [db_cli path] [db path]\n\n",
+             "mix: weights of deposit, send, withdraw, account, defi, claim and chain, e.g. deposit=4,send=4,chain=1");
+        return -1;
+    }
+
+    const size_t num_blocks = std::stoul(args[1]);
+    const auto txs_per_inner = static_cast<uint32_t>(std::stoul(args[2]));
+    const auto inners_per_root = static_cast<uint32_t>(std::stoul(args[3]));
+    const TxMix mix(args[4]);
+    const size_t workers = std::max(std::stoul(args[5]), 1UL);
+    const size_t blocks_ahead = std::max(std::stoul(args[6]), 1UL);
+    const bool mock_proofs = args[7] == "true";
+    const std::string rollup_cli_path = args[8];
+    const std::string db_cli_path = args.size() > 9 ? args[9] : "";
+    const std::string db_path = args.size() > 10 ? args[10] : "./data/tx_load_world_state.db";
+
+    info("Blocks: ", num_blocks, " of ", inners_per_root, " x ", txs_per_inner, " txs.");
+    info("Mix: ", mix.to_string());
+    info("Workers: ", workers, ", blocks ahead: ", blocks_ahead, ", mock proofs: ", mock_proofs);
+
+    auto crs = std::make_shared<waffle::DynamicFileReferenceStringFactory>(CRS_PATH);
+    std::vector<ClientKeys> prover_keys;
+    for (size_t i = 0; i < workers; ++i) {
+        prover_keys.push_back({ join_split::get_circuit_data(crs, mock_proofs),
+                                account::get_circuit_data(crs, mock_proofs),
+                                claim::get_circuit_data(crs, mock_proofs) });
+    }
+
+    BlockQueue queue(blocks_ahead);
+    std::thread builder([&]() {
+        BlockFactory factory(prover_keys[0], prover_keys, mix, txs_per_inner, inners_per_root);
+        for (size_t i = 0; i < num_blocks; ++i) {
+            Timer timer;
+            auto block = factory.create_block();
+            info("Built block ", i, " in ", timer.toString(), "s.");
+            queue.push(std::move(block));
+        }
+    });
+
+    ::rollup::process::Process rollup_cli({ rollup_cli_path,
+                                  CRS_PATH,
+                                  std::to_string(txs_per_inner),
+                                  std::to_string(inners_per_root),
+                                  mock_proofs ? "true" : "false",
+                                  "false",
+                                  "true",
+                                  "./data" });
+    std::unique_ptr<::rollup::process::Process> db_cli;
+    if (!db_cli_path.empty()) {
+        db_cli = std::make_unique<::rollup::process::Process>(std::vector<std::string>{ db_cli_path, db_path });
+        read_db_metadata(db_cli->output());
+    }
+
+    using serialize::read;
+    using serialize::write;
+    std::map<std::string, std::vector<double>> latencies;
+    auto timed = [&](std::string const& name, auto const& request) {
+        auto start = clock_type::now();
+        request();
+        latencies[name].push_back(std::chrono::duration<double>(clock_type::now() - start).count());
+    };
+    auto send = [&](uint32_t proof_id, auto const& request) {
+        auto& in = rollup_cli.input();
+        write(in, proof_id);
+        write(in, request);
+        in.flush();
+    };
+    auto receive = [&](char const* name) {
+        auto& out = rollup_cli.output();
+        std::vector<uint8_t> proof_data;
+        bool verified = false;
+        read(out, proof_data);
+        read(out, verified);
+        if (!verified) {
+            throw_or_abort(format("Received an unverified ", name, " proof."));
+        }
+        return proof_data;
+    };
+
+    // Wait for the blocks ahead, and for rollup_cli to load its keys, before starting the clock.
+    while (queue.size() < std::min(blocks_ahead, num_blocks)) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+    write(rollup_cli.input(), uint32_t(requests::PING));
+    rollup_cli.input().flush();
+    bool pong;
+    read(rollup_cli.output(), pong);
+
+    info("Starting load...");
+    auto start = clock_type::now();
+    double stalled = 0;
+    size_t num_txs = 0;
+    std::map<TxType, size_t> tx_counts;
+    for (size_t i = 0; i < num_blocks; ++i) {
+        auto wait_start = clock_type::now();
+        auto block = queue.pop();
+        stalled += std::chrono::duration<double>(clock_type::now() - wait_start).count();
+        for (auto const& [type, count] : block.tx_counts) {
+            tx_counts[type] += count;
+            num_txs += type == CHAIN ? 2 * count : count;
+        }
+
+        timed("block", [&]() {
+            std::vector<std::vector<uint8_t>> tx_rollup_proofs;
+            for (size_t j = 0; j < block.tx_rollups.size(); ++j) {
+                timed("tx_rollup", [&]() {
+                    send(requests::TX_ROLLUP, block.tx_rollups[j]);
+                    tx_rollup_proofs.push_back(receive("tx rollup"));
+                });
+                // rollup_cli keeps the proofs it returns, so they're referred to by hash rather than sent back.
+                block.root_rollup.rollups[j] = artifact_ref(tx_rollup_proofs.back());
+            }
+            std::vector<uint8_t> root_rollup_proof;
+            timed("root_rollup", [&]() {
+                send(requests::ROOT_ROLLUP_BY_REFERENCE, block.root_rollup);
+                root_rollup_proof = receive("root rollup");
+            });
+            timed("root_verifier", [&]() {
+                send(requests::ROOT_VERIFIER_BY_REFERENCE, artifact_ref(root_rollup_proof));
+                receive("root verifier");
+            });
+            if (db_cli) {
+                auto& in = db_cli->input();
+                auto& out = db_cli->output();
+                auto puts = world_state_updates(block, tx_rollup_proofs);
+                timed("db_batch_put", [&]() {
+                    write(in, static_cast<uint8_t>(BATCH_PUT));
+                    write(in, puts);
+                    in.flush();
+                    read_db_metadata(out);
+                });
+                timed("db_commit", [&]() {
+                    write(in, static_cast<uint8_t>(COMMIT));
+                    in.flush();
+                    read_db_metadata(out);
+                });
+            }
+        });
+        info("Block ", i, " proven in ", latencies["block"].back(), "s.");
+    }
+    auto elapsed = std::chrono::duration<double>(clock_type::now() - start).count();
+    builder.join();
+    rollup_cli.wait();
+    if (db_cli) {
+        db_cli->wait();
+    }
+
+    ::rollup::latency::print_header(std::cout);
+    for (auto const& name : { "tx_rollup", "root_rollup", "root_verifier", "db_batch_put", "db_commit", "block" }) {
+        ::rollup::latency::print_row(std::cout, name, "load", latencies[name]);
+    }
+    std::cout << "txs:";
+    for (auto const& [type, count] : tx_counts) {
+        std::cout << " " << tx_type_name(type) << "=" << count;
+    }
+    std::cout << std::endl;
+    std::cout << "blocks: " << num_blocks << " in " << elapsed << "s, " << double(num_blocks) * 3600 / elapsed
+              << " blocks/hour, " << double(num_txs) / elapsed << " txs/s" << std::endl;
+    std::cout << "waiting for blocks: " << stalled << "s (" << 100 * stalled / elapsed << "%)" << std::endl;
+
+    return 0;
+}
@@ -1,4 +1,5 @@
 #include "../proofs/join_split/index.hpp"
+#include "../proofs/proof_pool.hpp"
 #include "../proofs/rollup/index.hpp"
 #include "../proofs/root_rollup/index.hpp"
 #include "../proofs/root_verifier/index.hpp"
@@ -18,16 +19,13 @@ using WorldState = ::rollup::world_state::WorldState<MemoryStore>;
 
 tx_rollup::rollup_tx create_inner_rollup(uint32_t num_txs,
                                          uint32_t rollup_size,
-                                         join_split::circuit_data const& join_split_circuit_data,
-                                         barretenberg::fr const& data_tree_root,
-                                         WorldState& world_state,
-                                         bool mock_proofs)
+                                         std::function<std::vector<uint8_t>()> const& create_noop_proof,
+                                         WorldState& world_state)
 {
     info("Generating a ", rollup_size, " rollup with ", num_txs, " txs...");
     auto proofs = std::vector<std::vector<uint8_t>>(num_txs);
     for (size_t i = 0; i < num_txs; ++i) {
-        proofs[i] =
-            join_split::create_noop_join_split_proof(join_split_circuit_data, data_tree_root, true, mock_proofs);
+        proofs[i] = create_noop_proof();
     }
     return tx_rollup::create_rollup_tx(world_state, rollup_size, proofs);
 }
@@ -42,7 +40,8 @@ int main(int argc, char** argv)
     if (args.size() < 4) {
         info("usage:\n",
              args[0],
-             " <num_txs> <inner_rollup_size> <outer_rollup_size> <split_proofs_across_rollups> [output_file]");
+             " <num_txs> <inner_rollup_size> <outer_rollup_size> <split_proofs_across_rollups> [mock_proofs] "
+             "[output_file] [proof_pool_path] [proof_pool_workers]");
         return -1;
     }
 
@@ -51,12 +50,40 @@ int main(int argc, char** argv)
     const uint32_t outer_rollup_size = static_cast<uint32_t>(std::stoul(args[3]));
     const bool split_txns_across_rollups = args.size() > 4 ? args[4] == "true" : true;
     const bool mock_proofs = args.size() > 5 ? args[5] == "true" : true;
-    const std::string output_file = args[6];
+    const std::string output_file = args.size() > 6 ? args[6] : "";
+    const std::string proof_pool_path = args.size() > 7 ? args[7] : "";
+    const size_t proof_pool_workers = args.size() > 8 ? std::stoul(args[8]) : 1;
 
     auto crs = std::make_shared<waffle::DynamicFileReferenceStringFactory>("../barretenberg/cpp/srs_db/ignition");
     auto join_split_circuit_data = join_split::get_circuit_data(crs, mock_proofs);
     auto data_root = world_state.data_tree.root();
-    world_state.root_tree.update_element(0, data_root);
+    world_state.insert_root_entry(0, data_root);
+
+    // Noop proofs are independent of each other, so with a pool they're made ahead on idle cores, and persisted for
+    // the next run, rather than one at a time as each rollup is built. They're only valid against the data root, which
+    // is that of an empty tree in every run, and the circuit's verification key.
+    // The workers prove with these keys until the pool is destroyed, so they must outlive it.
+    std::vector<join_split::circuit_data> worker_circuit_data;
+    std::unique_ptr<ProofPool> proof_pool;
+    auto vk_hash = from_buffer<uint256_t>(join_split_circuit_data.verification_key->sha256_hash());
+    auto pool_source = format("join_split_noop_", mock_proofs ? "mock_" : "", data_root, "_", vk_hash);
+    if (!proof_pool_path.empty()) {
+        // The main thread doesn't prove once there's a pool, so the first worker can have its keys.
+        worker_circuit_data.push_back(join_split_circuit_data);
+        for (size_t i = 1; i < proof_pool_workers; ++i) {
+            worker_circuit_data.push_back(join_split::get_circuit_data(crs, mock_proofs));
+        }
+        proof_pool = std::make_unique<ProofPool>(proof_pool_path, proof_pool_workers);
+        proof_pool->add(pool_source, num_txs, [&](size_t worker) {
+            return join_split::create_noop_join_split_proof(worker_circuit_data[worker], data_root, true, mock_proofs);
+        });
+    }
+    auto create_noop_proof = [&]() {
+        if (proof_pool) {
+            return proof_pool->take(pool_source);
+        }
+        return join_split::create_noop_join_split_proof(join_split_circuit_data, data_root, true, mock_proofs);
+    };
 
     Timer timer;
 
@@ -66,8 +93,7 @@ int main(int argc, char** argv)
         auto n = split_txns_across_rollups ? (num_total_txs / outer_rollup_size) : std::min(num_txs, inner_rollup_size);
         num_txs -= n;
 
-        auto rollup =
-            create_inner_rollup(n, inner_rollup_size, join_split_circuit_data, data_root, world_state, mock_proofs);
+        auto rollup = create_inner_rollup(n, inner_rollup_size, create_noop_proof, world_state);
 
         info("Sending tx rollup request with ", n, " txs...");
         write(std::cout, (uint32_t)0);
@@ -0,0 +1,79 @@
+#pragma once
+#include <common/throw_or_abort.hpp>
+#include <algorithm>
+#include <array>
+#include <random>
+#include <sstream>
+#include <string>
+
+namespace rollup {
+namespace tx_factory {
+
+enum TxType { DEPOSIT, SEND, WITHDRAW, ACCOUNT, DEFI_DEPOSIT, CLAIM, CHAIN, NUM_TX_TYPES };
+
+inline char const* tx_type_name(TxType type)
+{
+    // In the order of the tx types.
+    static char const* const names[] = { "deposit", "send", "withdraw", "account", "defi", "claim", "chain" };
+    return names[type];
+}
+
+/**
+ * Relative weights of each type of tx in a block, e.g. `deposit=4,send=4,withdraw=1,chain=1`. A chain is a send and
+ * a second send spending its output in the same tx rollup, so takes two slots.
+ */
+class TxMix {
+  public:
+    explicit TxMix(std::string const& spec)
+    {
+        weights_.fill(0);
+        std::istringstream is(spec);
+        std::string entry;
+        while (std::getline(is, entry, ',')) {
+            auto eq = entry.find('=');
+            auto name = entry.substr(0, eq);
+            size_t type = 0;
+            while (type < NUM_TX_TYPES && name != tx_type_name(TxType(type))) {
+                ++type;
+            }
+            if (type == NUM_TX_TYPES) {
+                throw_or_abort("Unknown tx type in mix: " + name);
+            }
+            weights_[type] = eq == std::string::npos ? 1 : std::stod(entry.substr(eq + 1));
+        }
+    }
+
+    /**
+     * Draws the type of the next tx. Chains aren't drawn if there's only room for one more tx in the tx rollup, sends
+     * taking their place if the mix has nothing else.
+     */
+    TxType draw(std::mt19937& engine, bool allow_chain) const
+    {
+        auto weights = weights_;
+        if (!allow_chain) {
+            weights[CHAIN] = 0;
+        }
+        if (std::all_of(weights.begin(), weights.end(), [](double w) { return w == 0; })) {
+            return SEND;
+        }
+        std::discrete_distribution<size_t> distribution(weights.begin(), weights.end());
+        return TxType(distribution(engine));
+    }
+
+    std::string to_string() const
+    {
+        std::ostringstream os;
+        for (size_t type = 0; type < NUM_TX_TYPES; ++type) {
+            if (weights_[type] > 0) {
+                os << (os.tellp() > 0 ? "," : "") << tx_type_name(TxType(type)) << "=" << weights_[type];
+            }
+        }
+        return os.str();
+    }
+
+  private:
+    std::array<double, NUM_TX_TYPES> weights_;
+};
+
+} // namespace tx_factory
+} // namespace rollup
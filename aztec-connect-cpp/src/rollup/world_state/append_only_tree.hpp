@@ -0,0 +1,303 @@
+#pragma once
+#include "tree_reader.hpp"
+#include <stdlib/merkle_tree/hash_path.hpp>
+#include <stdlib/merkle_tree/merkle_tree.hpp>
+#include <common/serialize.hpp>
+#include <common/throw_or_abort.hpp>
+
+namespace rollup {
+namespace world_state {
+
+using namespace barretenberg;
+using namespace plonk::stdlib::merkle_tree;
+
+/**
+ * A merkle tree for the append only data and root trees. It reads the store format MerkleTree writes, so opens existing
+ * trees, and keeps its root and size in the same metadata record.
+ *
+ * The right edge of the tree is held in memory: the leaves and nodes of the rightmost, partly filled subtree of
+ * SUBTREE_SIZE leaves, and above it the completed left sibling at each height. Appending at the tree size then needs no
+ * reads, and hashes only the new nodes and the right edge above them. A subtree is written as a single record of all
+ * its nodes (leaves first, the root's children last) once it fills, rather than as a node record per hash.
+ *
+ * Writing below the tree size, or far beyond it, updates the element's path as MerkleTree would, and reloads the right
+ * edge.
+ *
+ * The root, size and right edge are only read from the store on construction and by `reload`, so the tree must be
+ * reloaded whenever its store changes underneath it: a rollback, or another writer's changes being applied to it.
+ */
+template <typename Store> class AppendOnlyTree {
+  public:
+    static constexpr size_t SUBTREE_HEIGHT = 5;
+    static constexpr size_t SUBTREE_SIZE = 1UL << SUBTREE_HEIGHT;
+    // The most empty leaves padded to append past the tree size, as when the rollup pads the data tree.
+    static constexpr size_t MAX_APPEND_GAP = 1UL << 16;
+
+    AppendOnlyTree(Store& store, size_t depth, uint8_t tree_id)
+        : store_(store)
+        , depth_(depth)
+        , tree_id_(tree_id)
+        , reader_(store, depth)
+        , zero_hashes_(reader_.zero_hashes())
+        , left_(depth + 1, fr::zero())
+        , subtree_(SUBTREE_HEIGHT + 1)
+    {
+        if (depth_ < SUBTREE_HEIGHT) {
+            throw_or_abort("Append only tree is shallower than its subtrees.");
+        }
+        reload();
+    }
+
+    AppendOnlyTree(AppendOnlyTree const&) = delete;
+    AppendOnlyTree& operator=(AppendOnlyTree const&) = delete;
+
+    /**
+     * Reads the root, size and right edge back from the store.
+     */
+    void reload()
+    {
+        std::vector<uint8_t> data;
+        if (store_.get(std::vector<uint8_t>{ tree_id_ }, data)) {
+            root_ = from_buffer<fr>(data, 0);
+            size_ = from_buffer<uint256_t>(data, 32);
+        } else {
+            root_ = zero_hashes_[depth_];
+            size_ = 0;
+        }
+        left_.assign(depth_ + 1, fr::zero());
+        load_right_edge();
+    }
+
+    fr root() const { return root_; }
+
+    uint256_t size() const { return size_; }
+
+    size_t depth() const { return depth_; }
+
+    fr_hash_path get_hash_path(uint256_t const& index) const { return reader_.get_hash_path(root_, index); }
+
+    fr update_element(uint256_t const& index, fr const& value) { return update_elements(index, { value }); }
+
+    /**
+     * Writes consecutive values from the given index. Values at or past the tree size are appended, after padding a gap
+     * of up to MAX_APPEND_GAP empty leaves, so a run that overlaps the end of the tree or starts a little past it still
+     * takes the append path. Values below the size, or past a wider gap, update their paths one by one.
+     */
+    fr update_elements(uint256_t const& start_index, std::vector<fr> const& values)
+    {
+        size_t i = 0;
+        for (; i < values.size() && start_index + i < size_; ++i) {
+            update_path(start_index + i, values[i]);
+        }
+        if (i == values.size()) {
+            return root_;
+        }
+
+        auto gap = start_index + i - size_;
+        if (gap > MAX_APPEND_GAP) {
+            for (; i < values.size(); ++i) {
+                update_path(start_index + i, values[i]);
+            }
+            return root_;
+        }
+        std::vector<fr> appended(static_cast<size_t>(gap), fr::zero());
+        appended.insert(appended.end(), values.begin() + (long)i, values.end());
+        append(appended);
+        return root_;
+    }
+
+  private:
+    void append(std::vector<fr> const& values)
+    {
+        if (values.empty()) {
+            return;
+        }
+        auto first = size_ >> SUBTREE_HEIGHT;
+        std::vector<fr> subtree_roots;
+        for (size_t i = 0; i < values.size();) {
+            auto from = subtree_size_;
+            auto count = std::min(SUBTREE_SIZE - from, values.size() - i);
+            std::copy(values.begin() + (long)i, values.begin() + (long)(i + count), subtree_[0].begin() + (long)from);
+            subtree_size_ += count;
+            i += count;
+            subtree_roots.push_back(update_subtree(from));
+            if (subtree_size_ == SUBTREE_SIZE) {
+                clear_subtree();
+            }
+        }
+        size_ += values.size();
+        update_right_edge(first, subtree_roots);
+        write_metadata();
+    }
+
+    /**
+     * Hashes the rightmost subtree's nodes over its leaves from the given position, and writes them out if asked.
+     */
+    fr update_subtree(size_t from, bool persist = true)
+    {
+        bool full = subtree_size_ == SUBTREE_SIZE;
+        auto to = subtree_size_;
+        for (size_t height = 1; height <= SUBTREE_HEIGHT; ++height) {
+            from >>= 1;
+            to = ((to - 1) >> 1) + 1;
+            auto const& children = subtree_[height - 1];
+            for (size_t i = from; i < to; ++i) {
+                subtree_[height][i] = hash_children(height, children[i * 2], children[i * 2 + 1], persist && !full);
+            }
+        }
+
+        auto root = subtree_[SUBTREE_HEIGHT][0];
+        if (persist && full && root != zero_hashes_[SUBTREE_HEIGHT]) {
+            std::vector<uint8_t> data;
+            for (size_t height = 0; height < SUBTREE_HEIGHT; ++height) {
+                for (auto const& node : subtree_[height]) {
+                    write(data, node);
+                }
+            }
+            store_.put(to_buffer(root), data);
+        }
+        return root;
+    }
+
+    void clear_subtree()
+    {
+        for (size_t height = 0; height <= SUBTREE_HEIGHT; ++height) {
+            subtree_[height].assign(SUBTREE_SIZE >> height, zero_hashes_[height]);
+        }
+        subtree_size_ = 0;
+    }
+
+    /**
+     * Hashes the nodes above updated subtree roots up to the root. `first` is the position of the first updated
+     * subtree.
+     */
+    void update_right_edge(uint256_t first, std::vector<fr> level)
+    {
+        for (size_t height = SUBTREE_HEIGHT; height < depth_; ++height) {
+            std::vector<fr> parents;
+            size_t i = 0;
+            if (first & 1) {
+                parents.push_back(hash_children(height + 1, left_[height], level[0]));
+                i = 1;
+            }
+            for (; i < level.size(); i += 2) {
+                auto right = i + 1 < level.size() ? level[i + 1] : zero_hashes_[height];
+                parents.push_back(hash_children(height + 1, level[i], right));
+            }
+
+            // The completed left sibling of the new right edge, if it moved.
+            auto position = size_ >> height;
+            if ((position & 1) && position - 1 >= first) {
+                left_[height] = level[static_cast<size_t>(position - 1 - first)];
+            }
+
+            first >>= 1;
+            level = std::move(parents);
+        }
+        root_ = level[0];
+    }
+
+    void update_path(uint256_t const& index, fr const& value)
+    {
+        auto path = get_hash_path(index);
+        auto node = value;
+        for (size_t height = 0; height < depth_; ++height) {
+            node = index.get_bit(height) ? hash_children(height + 1, path[height].first, node)
+                                         : hash_children(height + 1, node, path[height].second);
+        }
+        root_ = node;
+        size_ = std::max(size_, index + 1);
+        write_metadata();
+        load_right_edge();
+    }
+
+    /**
+     * Reads the right edge back from the store, walking down the path of the last leaf.
+     */
+    void load_right_edge()
+    {
+        clear_subtree();
+        if (size_ == 0) {
+            return;
+        }
+        auto last = size_ - 1;
+        auto node = root_;
+        for (size_t height = depth_; height > SUBTREE_HEIGHT; --height) {
+            auto [left, right] = reader_.read_children(node, height);
+            left_[height - 1] = left;
+            node = last.get_bit(height - 1) ? right : left;
+        }
+
+        subtree_size_ = static_cast<size_t>(size_ & (SUBTREE_SIZE - 1));
+        if (subtree_size_ == 0) {
+            return;
+        }
+        read_leaves(node, SUBTREE_HEIGHT, 0);
+        update_subtree(0, false);
+    }
+
+    /**
+     * Reads the leaves of the subtree at the given node into the rightmost subtree, from the given position.
+     */
+    void read_leaves(fr const& node, size_t height, size_t position)
+    {
+        if (height == 0) {
+            subtree_[0][position] = node;
+            return;
+        }
+        std::vector<uint8_t> data;
+        if (node == zero_hashes_[height] || !store_.get(to_buffer(node), data)) {
+            return;
+        }
+        if (data.size() == 64) {
+            read_leaves(from_buffer<fr>(data, 0), height - 1, position * 2);
+            read_leaves(from_buffer<fr>(data, 32), height - 1, position * 2 + 1);
+        } else if (data.size() == 65) {
+            auto leaf_index = static_cast<size_t>(from_buffer<uint256_t>(data, 32) & uint256_t((1UL << height) - 1));
+            subtree_[0][(position << height) + leaf_index] = from_buffer<fr>(data, 0);
+        } else {
+            for (size_t i = 0; i < (1UL << height); ++i) {
+                subtree_[0][(position << height) + i] = from_buffer<fr>(data, i * 32);
+            }
+        }
+    }
+
+    fr hash_children(size_t height, fr const& left, fr const& right, bool store = true)
+    {
+        if (left == zero_hashes_[height - 1] && right == zero_hashes_[height - 1]) {
+            return zero_hashes_[height];
+        }
+        auto parent = compress_native(left, right);
+        if (store) {
+            std::vector<uint8_t> data;
+            write(data, left);
+            write(data, right);
+            store_.put(to_buffer(parent), data);
+        }
+        return parent;
+    }
+
+    void write_metadata()
+    {
+        std::vector<uint8_t> data;
+        write(data, root_);
+        write(data, size_);
+        store_.put(std::vector<uint8_t>{ tree_id_ }, data);
+    }
+
+    Store& store_;
+    size_t depth_;
+    uint8_t tree_id_;
+    TreeReader<Store> reader_;
+    std::vector<fr> zero_hashes_;
+    fr root_;
+    uint256_t size_;
+    // Completed left sibling of the right edge at each height above the rightmost subtree, where there is one.
+    std::vector<fr> left_;
+    // Nodes of the rightmost subtree, by height, and its number of leaves.
+    std::vector<std::vector<fr>> subtree_;
+    size_t subtree_size_ = 0;
+};
+
+} // namespace world_state
+} // namespace rollup
@@ -0,0 +1,245 @@
+#include "append_only_tree.hpp"
+#include <common/test.hpp>
+#include <stdlib/merkle_tree/index.hpp>
+
+namespace rollup {
+namespace world_state {
+
+using namespace barretenberg;
+using namespace plonk::stdlib::merkle_tree;
+
+namespace {
+constexpr size_t DEPTH = 10;
+
+std::vector<fr> random_values(size_t n)
+{
+    std::vector<fr> values(n);
+    for (auto& value : values) {
+        value = fr::random_element();
+    }
+    return values;
+}
+
+// Counts the writes to the store, to show which path a write took.
+struct CountingStore : public MemoryStore {
+    void put(std::vector<uint8_t> const& key, std::vector<uint8_t> const& value)
+    {
+        ++puts;
+        MemoryStore::put(key, value);
+    }
+
+    size_t puts = 0;
+};
+} // namespace
+
+class append_only_tree_tests : public ::testing::Test {
+  protected:
+    append_only_tree_tests()
+        : tree(store, DEPTH, 0)
+        , reference(reference_store, DEPTH, 0)
+    {}
+
+    void append(std::vector<fr> const& values)
+    {
+        auto start = tree.size();
+        tree.update_elements(start, values);
+        for (size_t i = 0; i < values.size(); ++i) {
+            reference.update_element(start + i, values[i]);
+        }
+    }
+
+    // Writes the values to the reference, one by one.
+    void write_reference(size_t start, std::vector<fr> const& values)
+    {
+        for (size_t i = 0; i < values.size(); ++i) {
+            reference.update_element(start + i, values[i]);
+        }
+    }
+
+    template <typename Store> void expect_matches_reference(AppendOnlyTree<Store>& t)
+    {
+        EXPECT_EQ(t.root(), reference.root());
+        EXPECT_EQ(t.size(), reference.size());
+        for (size_t i = 0; i < static_cast<size_t>(reference.size()) + 2; ++i) {
+            EXPECT_EQ(t.get_hash_path(i), reference.get_hash_path(i));
+        }
+    }
+
+    MemoryStore store;
+    AppendOnlyTree<MemoryStore> tree;
+    MemoryStore reference_store;
+    MerkleTree<MemoryStore> reference;
+};
+
+TEST_F(append_only_tree_tests, appends_match_merkle_tree)
+{
+    expect_matches_reference(tree);
+
+    append(random_values(1));
+    expect_matches_reference(tree);
+
+    // Fills the first subtree, then part of the next.
+    append(random_values(40));
+    expect_matches_reference(tree);
+
+    // Spans several subtrees.
+    append(random_values(100));
+    expect_matches_reference(tree);
+}
+
+TEST_F(append_only_tree_tests, single_appends_match_merkle_tree)
+{
+    for (size_t i = 0; i < 70; ++i) {
+        append(random_values(1));
+        EXPECT_EQ(tree.root(), reference.root());
+    }
+    expect_matches_reference(tree);
+}
+
+TEST_F(append_only_tree_tests, updates_and_gaps_match_merkle_tree)
+{
+    append(random_values(45));
+
+    // Update a leaf in a full subtree, and one in the rightmost subtree.
+    auto value = fr::random_element();
+    tree.update_element(3, value);
+    reference.update_element(3, value);
+    tree.update_element(44, value);
+    reference.update_element(44, value);
+    expect_matches_reference(tree);
+
+    // Skip ahead, as the rollup does when padding the data tree.
+    tree.update_element(127, fr::zero());
+    reference.update_element(127, fr::zero());
+    expect_matches_reference(tree);
+
+    append(random_values(33));
+    expect_matches_reference(tree);
+}
+
+TEST_F(append_only_tree_tests, runs_below_the_size_match_merkle_tree)
+{
+    append(random_values(100));
+
+    // A run within the tree updates each path.
+    auto values = random_values(30);
+    tree.update_elements(10, values);
+    write_reference(10, values);
+    expect_matches_reference(tree);
+
+    append(random_values(10));
+    expect_matches_reference(tree);
+}
+
+TEST_F(append_only_tree_tests, runs_overlapping_the_end_append_past_it)
+{
+    CountingStore counting_store;
+    AppendOnlyTree<CountingStore> counted(counting_store, DEPTH, 0);
+    auto values = random_values(45);
+    counted.update_elements(0, values);
+    write_reference(0, values);
+
+    // The first 5 values update their paths, and the other 55 are appended. Updating every path would cost a write per
+    // node on each path, but appending costs fewer writes than there are values.
+    auto start_puts = counting_store.puts;
+    values = random_values(60);
+    counted.update_elements(40, values);
+    write_reference(40, values);
+    EXPECT_LT(counting_store.puts - start_puts, 5 * (DEPTH + 1) + 55);
+    expect_matches_reference(counted);
+
+    values = random_values(10);
+    counted.update_elements(counted.size(), values);
+    write_reference(100, values);
+    expect_matches_reference(counted);
+}
+
+TEST_F(append_only_tree_tests, runs_past_a_gap_append_after_padding)
+{
+    append(random_values(45));
+
+    // Starts 25 leaves past the end, as a split BATCH_PUT run or the rollup's padding of the data tree leaves a gap.
+    auto values = random_values(40);
+    tree.update_elements(70, values);
+    write_reference(70, values);
+    expect_matches_reference(tree);
+
+    append(random_values(20));
+    expect_matches_reference(tree);
+}
+
+TEST_F(append_only_tree_tests, reloads_from_store)
+{
+    append(random_values(50));
+
+    AppendOnlyTree<MemoryStore> reloaded(store, DEPTH, 0);
+    expect_matches_reference(reloaded);
+
+    auto values = random_values(20);
+    reloaded.update_elements(reloaded.size(), values);
+    for (size_t i = 0; i < values.size(); ++i) {
+        reference.update_element(50 + i, values[i]);
+    }
+    expect_matches_reference(reloaded);
+}
+
+TEST_F(append_only_tree_tests, reload_sees_changes_to_store)
+{
+    append(random_values(50));
+
+    // Another tree over the same store appends, as applying an overlay or rolling back changes the store underneath.
+    AppendOnlyTree<MemoryStore> writer(store, DEPTH, 0);
+    auto values = random_values(30);
+    writer.update_elements(writer.size(), values);
+    for (size_t i = 0; i < values.size(); ++i) {
+        reference.update_element(50 + i, values[i]);
+    }
+
+    tree.reload();
+    expect_matches_reference(tree);
+
+    append(random_values(5));
+    expect_matches_reference(tree);
+}
+
+TEST_F(append_only_tree_tests, serves_paths_below_past_roots)
+{
+    append(random_values(40));
+    auto past_root = tree.root();
+    std::vector<fr_hash_path> past_paths;
+    for (size_t i = 0; i < 42; ++i) {
+        past_paths.push_back(reference.get_hash_path(i));
+    }
+
+    append(random_values(30));
+    tree.update_element(7, fr::random_element());
+
+    TreeReader<MemoryStore> reader(store, DEPTH);
+    for (size_t i = 0; i < past_paths.size(); ++i) {
+        EXPECT_EQ(reader.get_hash_path(past_root, i), past_paths[i]);
+    }
+}
+
+TEST_F(append_only_tree_tests, opens_merkle_tree)
+{
+    MemoryStore merkle_tree_store;
+    MerkleTree<MemoryStore> original(merkle_tree_store, DEPTH, 0);
+    auto values = random_values(37);
+    for (size_t i = 0; i < values.size(); ++i) {
+        original.update_element(i, values[i]);
+        reference.update_element(i, values[i]);
+    }
+
+    AppendOnlyTree<MemoryStore> opened(merkle_tree_store, DEPTH, 0);
+    expect_matches_reference(opened);
+
+    values = random_values(30);
+    opened.update_elements(opened.size(), values);
+    for (size_t i = 0; i < values.size(); ++i) {
+        reference.update_element(37 + i, values[i]);
+    }
+    expect_matches_reference(opened);
+}
+
+} // namespace world_state
+} // namespace rollup
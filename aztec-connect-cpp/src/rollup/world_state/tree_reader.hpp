@@ -0,0 +1,129 @@
+#pragma once
+#include <stdlib/merkle_tree/hash_path.hpp>
+#include <stdlib/merkle_tree/merkle_tree.hpp>
+#include <common/serialize.hpp>
+#include <common/throw_or_abort.hpp>
+
+namespace rollup {
+namespace world_state {
+
+using namespace barretenberg;
+using namespace plonk::stdlib::merkle_tree;
+
+/**
+ * Reads hash paths out of a store below any root, not just a tree's current one. Nodes are keyed by their hash and
+ * never overwritten, so every root a tree has had can still be walked down, as long as its nodes haven't been pruned.
+ *
+ * Understands the records of both MerkleTree and AppendOnlyTree: plain nodes (left and right child), stumps (the only
+ * leaf of a subtree and its index), and full subtrees (all their nodes from the leaves up).
+ */
+template <typename Store> class TreeReader {
+  public:
+    TreeReader(Store& store, size_t depth)
+        : store_(store)
+        , depth_(depth)
+        , zero_hashes_(depth + 1)
+    {
+        zero_hashes_[0] = fr::zero();
+        for (size_t i = 0; i < depth_; ++i) {
+            zero_hashes_[i + 1] = compress_native(zero_hashes_[i], zero_hashes_[i]);
+        }
+    }
+
+    std::vector<fr> const& zero_hashes() const { return zero_hashes_; }
+
+    fr_hash_path get_hash_path(fr const& root, uint256_t const& index) const
+    {
+        fr_hash_path path(depth_);
+        auto node = root;
+        for (size_t height = depth_; height > 0; --height) {
+            std::vector<uint8_t> data;
+            if (node == zero_hashes_[height] || !store_.get(to_buffer(node), data)) {
+                for (size_t i = 0; i < height; ++i) {
+                    path[i] = { zero_hashes_[i], zero_hashes_[i] };
+                }
+                break;
+            }
+            if (data.size() == 64) {
+                path[height - 1] = { from_buffer<fr>(data, 0), from_buffer<fr>(data, 32) };
+                node = index.get_bit(height - 1) ? path[height - 1].second : path[height - 1].first;
+                continue;
+            }
+            if (data.size() == 65) {
+                get_stump_path(data, height, index, path);
+            } else {
+                get_subtree_path(data, height, index, path);
+            }
+            break;
+        }
+        return path;
+    }
+
+    std::pair<fr, fr> read_children(fr const& node, size_t height) const
+    {
+        std::vector<uint8_t> data;
+        if (node == zero_hashes_[height] || !store_.get(to_buffer(node), data)) {
+            return { zero_hashes_[height - 1], zero_hashes_[height - 1] };
+        }
+        if (data.size() == 64) {
+            return { from_buffer<fr>(data, 0), from_buffer<fr>(data, 32) };
+        }
+        fr_hash_path path(height);
+        auto index = data.size() == 65 ? from_buffer<uint256_t>(data, 32) : uint256_t(0);
+        if (data.size() == 65) {
+            get_stump_path(data, height, index, path);
+        } else {
+            get_subtree_path(data, height, index, path);
+        }
+        return path[height - 1];
+    }
+
+  private:
+    /**
+     * A stump is MerkleTree's record of a subtree holding a single leaf: the leaf value and index. Only the index's
+     * position within the subtree is used, the rest comes from the index being looked up.
+     */
+    void get_stump_path(std::vector<uint8_t> const& data,
+                        size_t height,
+                        uint256_t const& index,
+                        fr_hash_path& path) const
+    {
+        auto leaf = from_buffer<fr>(data, 0);
+        auto mask = (uint256_t(1) << height) - 1;
+        auto leaf_index = (index & ~mask) | (from_buffer<uint256_t>(data, 32) & mask);
+        for (size_t i = 0; i < height; ++i) {
+            bool on_leaf_path = (index >> (i + 1)) == (leaf_index >> (i + 1));
+            auto zero = zero_hashes_[i];
+            if (!on_leaf_path) {
+                path[i] = { zero, zero };
+            } else {
+                path[i] = leaf_index.get_bit(i) ? std::make_pair(zero, leaf) : std::make_pair(leaf, zero);
+            }
+            leaf = leaf_index.get_bit(i) ? compress_native(zero, leaf) : compress_native(leaf, zero);
+        }
+    }
+
+    void get_subtree_path(std::vector<uint8_t> const& data,
+                          size_t height,
+                          uint256_t const& index,
+                          fr_hash_path& path) const
+    {
+        if (data.size() != ((2UL << height) - 2) * 32) {
+            throw_or_abort(format("Bad subtree record at height ", height));
+        }
+        size_t offset = 0;
+        for (size_t i = 0; i < height; ++i) {
+            auto position = static_cast<size_t>((index >> i) & uint256_t((1UL << (height - i)) - 1)) & ~1UL;
+            auto pair = offset + position * 32;
+            path[i] = { from_buffer<fr>(data, pair), from_buffer<fr>(data, pair + 32) };
+            offset += (1UL << (height - i)) * 32;
+        }
+    }
+
+    Store& store_;
+    size_t depth_;
+    std::vector<fr> zero_hashes_;
+};
+
+} // namespace world_state
+} // namespace rollup
@@ -1,10 +1,13 @@
 #pragma once
 #include <stdlib/merkle_tree/merkle_tree.hpp>
+#include "append_only_tree.hpp"
 #include "../proofs/notes/native/defi_interaction/note.hpp"
 #include "../proofs/notes/native/value/value_note.hpp"
 #include "../proofs/notes/native/account/account_note.hpp"
 #include "../proofs/notes/native/claim/claim_note.hpp"
 #include "../constants.hpp"
+#include <map>
+#include <optional>
 
 namespace rollup {
 namespace world_state {
@@ -25,15 +28,18 @@ template <typename Store> class WorldState {
         update_root_tree_with_data_root();
     }
 
-    void update_root_tree_with_data_root()
+    void update_root_tree_with_data_root() { insert_root_entry(root_tree.size(), data_tree.root()); }
+
+    void insert_root_entry(uint256_t index, fr const& data_root)
     {
-        auto data_root = data_tree.root();
-        root_tree.update_element(root_tree.size(), data_root);
+        root_tree.update_element(index, data_root);
+        data_root_indices[uint256_t(data_root)] = static_cast<uint32_t>(index);
     }
 
     void insert_data_entry(uint256_t index, fr const& commitment, fr const& input_nullifier)
     {
         data_tree.update_element(index, commitment);
+        commitment_indices[uint256_t(commitment)] = static_cast<uint32_t>(index);
         input_nullifiers.resize(static_cast<size_t>(data_tree.size()));
         input_nullifiers[static_cast<size_t>(index)] = input_nullifier;
     }
@@ -55,14 +61,42 @@ template <typename Store> class WorldState {
         }
     }
 
+    /**
+     * Index of a note commitment in the data tree, if it's been inserted.
+     */
+    std::optional<uint32_t> find_commitment_index(fr const& commitment) const
+    {
+        return find(commitment_indices, commitment);
+    }
+
+    /**
+     * Index of a data root in the root tree, if it's been inserted.
+     */
+    std::optional<uint32_t> find_data_root_index(fr const& data_root) const
+    {
+        return find(data_root_indices, data_root);
+    }
+
     void nullify(uint256_t index) { null_tree.update_element(index, { 1 }); }
 
     Store store;
-    Tree data_tree;
+    AppendOnlyTree<Store> data_tree;
     Tree null_tree;
-    Tree root_tree;
+    AppendOnlyTree<Store> root_tree;
     Tree defi_tree;
     std::vector<barretenberg::fr> input_nullifiers;
+    std::map<uint256_t, uint32_t> commitment_indices;
+    std::map<uint256_t, uint32_t> data_root_indices;
+
+  private:
+    static std::optional<uint32_t> find(std::map<uint256_t, uint32_t> const& indices, fr const& value)
+    {
+        auto it = indices.find(uint256_t(value));
+        if (it == indices.end()) {
+            return std::nullopt;
+        }
+        return it->second;
+    }
 };
 
 } // namespace world_state
@@ -2,6 +2,7 @@ import { randomBytes } from 'crypto';
 import { WorldStateDb } from './index.js';
 import { WorldStateConstants } from '../world_state/index.js';
 import { MerkleTree } from '../merkle_tree/index.js';
+import { toBigIntBE, toBufferBE } from '../bigint_buffer/index.js';
 
 const randomFr = () => {
   const bytes = randomBytes(32);
@@ -81,6 +82,14 @@ describe('world_state_db', () => {
     expect(worldStateDb.getSize(0)).toEqual(BigInt(num));
   }, 60000);
 
+  it('should get a range of values', async () => {
+    const values = new Array(8).fill(0).map(randomFr);
+    await worldStateDb.batchPut(values.map((value, i) => ({ treeId: 0, index: BigInt(i), value })));
+
+    const result = await worldStateDb.getRange(0, BigInt(2), 8);
+    expect(result).toEqual([...values.slice(2), Buffer.alloc(32, 0), Buffer.alloc(32, 0)]);
+  });
+
   it('should update same value in both trees', async () => {
     const value1 = randomFr();
     const value2 = randomFr();
@@ -135,4 +144,147 @@ describe('world_state_db', () => {
       expect(hashPaths[i]).toEqual(hashPath);
     }
   });
+
+  it('should check nullifiers exist', async () => {
+    const [spent, unspent] = [randomFr(), randomFr()].map(toBigIntBE);
+    const one = toBufferBE(BigInt(1), 32);
+    await worldStateDb.put(1, spent, one);
+    expect(await worldStateDb.nullifiersExist([spent, unspent])).toEqual([true, false]);
+
+    await worldStateDb.rollback();
+    expect(await worldStateDb.nullifiersExist([spent, unspent])).toEqual([false, false]);
+
+    await worldStateDb.put(1, spent, one);
+    await worldStateDb.commit();
+    expect(await worldStateDb.fork('a')).toBe(true);
+    await worldStateDb.put(1, unspent, one);
+    expect(await worldStateDb.nullifiersExist([spent, unspent])).toEqual([true, true]);
+
+    await worldStateDb.select();
+    expect(await worldStateDb.nullifiersExist([spent, unspent])).toEqual([true, false]);
+    expect(await worldStateDb.nullifiersExist([])).toEqual([]);
+  });
+
+  it('should find leaf indices by value', async () => {
+    const values = new Array(3).fill(0).map(randomFr);
+    const size = worldStateDb.getSize(0);
+    await worldStateDb.batchPut(values.map((value, i) => ({ treeId: 0, index: size + BigInt(i), value })));
+    const missing = randomFr();
+    const indices = await worldStateDb.findLeafIndices(0, [values[2], missing, values[0]]);
+    expect(indices).toEqual([size + 2n, undefined, size]);
+
+    const dataRoot = worldStateDb.getRoot(0);
+    const rootIndex = worldStateDb.getSize(2);
+    await worldStateDb.put(2, rootIndex, dataRoot);
+    expect(await worldStateDb.findLeafIndices(2, [dataRoot])).toEqual([rootIndex]);
+
+    await worldStateDb.rollback();
+    expect(await worldStateDb.findLeafIndices(0, [values[0]])).toEqual([undefined]);
+  });
+
+  it('should get hash paths as of past versions', async () => {
+    // A version is recorded by each commit that adds a data root to the root tree, as a block does.
+    const version = Number(worldStateDb.getSize(2));
+    await worldStateDb.put(0, 0n, randomFr());
+    await worldStateDb.put(1, 5n, toBufferBE(1n, 32));
+    await worldStateDb.put(2, BigInt(version), worldStateDb.getRoot(0));
+    await worldStateDb.commit();
+    const dataPath = await worldStateDb.getHashPath(0, 0n);
+    const nullPath = await worldStateDb.getHashPath(1, 5n);
+
+    // Move on to the next version.
+    await worldStateDb.put(0, 0n, randomFr());
+    await worldStateDb.put(1, 6n, toBufferBE(1n, 32));
+    await worldStateDb.put(2, BigInt(version + 1), worldStateDb.getRoot(0));
+    await worldStateDb.commit();
+    const nextNullPath = await worldStateDb.getHashPath(1, 5n);
+
+    // A commit that doesn't grow the root tree records no version.
+    await worldStateDb.put(1, 7n, toBufferBE(1n, 32));
+    await worldStateDb.commit();
+
+    expect(await worldStateDb.getHashPathAt(0, version, 0n)).toEqual(dataPath);
+    expect(await worldStateDb.getHashPathAt(1, version, 5n)).toEqual(nullPath);
+    expect(await worldStateDb.getHashPathAt(1, version + 1, 5n)).toEqual(nextNullPath);
+    expect(await worldStateDb.getHashPathAt(1, version + 1, 5n)).not.toEqual(await worldStateDb.getHashPath(1, 5n));
+    expect(await worldStateDb.getHashPathAt(1, version + 2, 5n)).toBeUndefined();
+  });
+
+  it('should persist commits in the background', async () => {
+    const dbPath = `/tmp/world_state_db_${randomBytes(32).toString('hex')}.db`;
+    const asyncDb = new WorldStateDb(dbPath, { asyncCommit: true });
+    asyncDb.destroy();
+    await asyncDb.start();
+
+    const values = new Array(4).fill(0).map(randomFr);
+    for (const [i, value] of values.entries()) {
+      await asyncDb.put(0, BigInt(i), value);
+      await asyncDb.commit();
+      // Committed writes are readable whether or not they've reached disk.
+      expect(await asyncDb.get(0, BigInt(i))).toEqual(value);
+    }
+
+    const { committed, persisted } = await asyncDb.persisted(true);
+    expect(committed).toBeGreaterThanOrEqual(4n);
+    expect(persisted).toBe(committed);
+    asyncDb.stop();
+    asyncDb.destroy();
+  });
+
+  it('should build on overlays without touching the database', async () => {
+    const values = new Array(3).fill(0).map(randomFr);
+    await worldStateDb.put(0, BigInt(0), values[0]);
+    await worldStateDb.commit();
+    const committedRoot = worldStateDb.getRoot(0);
+
+    // Two candidate blocks built on the same state.
+    expect(await worldStateDb.fork('a')).toBe(true);
+    await worldStateDb.put(0, BigInt(1), values[1]);
+    const rootA = worldStateDb.getRoot(0);
+    expect(await worldStateDb.get(0, BigInt(0))).toEqual(values[0]);
+
+    expect(await worldStateDb.fork('b')).toBe(false);
+    await worldStateDb.select();
+    expect(await worldStateDb.fork('b')).toBe(true);
+    await worldStateDb.put(0, BigInt(1), values[2]);
+    expect(worldStateDb.getRoot(0)).not.toEqual(rootA);
+
+    // A block stacked on candidate a.
+    expect(await worldStateDb.fork('a2', 'a')).toBe(true);
+    await worldStateDb.put(0, BigInt(2), values[2]);
+    expect(await worldStateDb.drop('a')).toBe(false);
+
+    await worldStateDb.select();
+    expect(worldStateDb.getRoot(0)).toEqual(committedRoot);
+    expect(await worldStateDb.get(0, BigInt(1))).toEqual(Buffer.alloc(32, 0));
+
+    expect(await worldStateDb.drop('b')).toBe(true);
+    expect(await worldStateDb.merge('a2')).toBe(true);
+    expect(worldStateDb.getSize(0)).toBe(BigInt(3));
+    expect(await worldStateDb.merge('a')).toBe(true);
+    expect(worldStateDb.getSize(0)).toBe(BigInt(3));
+    expect(await worldStateDb.get(0, BigInt(1))).toEqual(values[1]);
+
+    await worldStateDb.commit();
+    expect(worldStateDb.getSize(0)).toBe(BigInt(3));
+  });
+
+  it('should refuse to merge an overlay whose parent changed since the fork', async () => {
+    const values = new Array(2).fill(0).map(randomFr);
+
+    // Two candidate blocks built on the same state.
+    expect(await worldStateDb.fork('a')).toBe(true);
+    await worldStateDb.put(0, BigInt(0), values[0]);
+    await worldStateDb.select();
+    expect(await worldStateDb.fork('b')).toBe(true);
+    await worldStateDb.put(0, BigInt(0), values[1]);
+
+    expect(await worldStateDb.merge('a')).toBe(true);
+    expect(await worldStateDb.merge('b')).toBe(false);
+    expect(await worldStateDb.drop('b')).toBe(true);
+    expect(await worldStateDb.get(0, BigInt(0))).toEqual(values[0]);
+
+    await worldStateDb.commit();
+    expect(worldStateDb.getSize(0)).toBe(BigInt(1));
+  });
 });
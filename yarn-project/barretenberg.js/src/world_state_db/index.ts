@@ -4,7 +4,7 @@ import { HashPath } from '../merkle_tree/index.js';
 import { toBigIntBE, toBufferBE } from '../bigint_buffer/index.js';
 import { ChildProcess, execSync, spawn } from 'child_process';
 import { PromiseReadable } from 'promise-readable';
-import { serializeBufferArrayToVector } from '../serialize/index.js';
+import { serializeBufferArrayToVector, serializeBufferToVector } from '../serialize/index.js';
 
 enum Command {
   GET,
@@ -13,6 +13,16 @@ enum Command {
   ROLLBACK,
   GET_PATH,
   BATCH_PUT,
+  GET_RANGE,
+  FORK,
+  SELECT,
+  MERGE,
+  DROP,
+  NULLIFIERS_EXIST,
+  FIND_LEAF_INDICES,
+  GET_PATH_AT,
+  PERSISTED,
+  STATS,
 }
 
 export enum RollupTreeId {
@@ -28,6 +38,18 @@ export interface PutEntry {
   value: Buffer;
 }
 
+export interface WorldStateDbOptions {
+  // Number of past versions to serve hash paths for with `getHashPathAt`, or 0 for all of them. Older versions stop
+  // being served, but their nodes' storage isn't reclaimed.
+  servedVersions?: number;
+  // Number of tree nodes db_cli caches in memory.
+  nodeCacheSize?: number;
+  // Acknowledge commits once logged, and write them to the database in the background. See `persisted`.
+  asyncCommit?: boolean;
+  // Path of a Prometheus text file db_cli exports its metrics to. See `stats`.
+  metricsPath?: string;
+}
+
 export class WorldStateDb {
   private proc?: ChildProcess;
   private stdout!: { read: (size: number) => Promise<Buffer> };
@@ -36,7 +58,7 @@ export class WorldStateDb {
   private sizes: bigint[] = [];
   private binPath = '../../aztec-connect-cpp/build/bin/db_cli';
 
-  constructor(private dbPath: string = './data/world_state.db') {}
+  constructor(private dbPath: string = './data/world_state.db', private options: WorldStateDbOptions = {}) {}
 
   public async start() {
     await this.launch();
@@ -82,6 +104,80 @@ export class WorldStateDb {
     return result;
   }
 
+  /**
+   * Returns `count` consecutive leaf values starting at `start`, or fewer if the tree ends first.
+   */
+  public getRange(treeId: number, start: bigint, count: number): Promise<Buffer[]> {
+    return new Promise(resolve => this.stdioQueue.put(async () => resolve(await this.getRange_(treeId, start, count))));
+  }
+
+  private async getRange_(treeId: number, start: bigint, count: number) {
+    const countBuf = Buffer.alloc(4);
+    countBuf.writeUInt32BE(count, 0);
+    const buffer = Buffer.concat([Buffer.from([Command.GET_RANGE, treeId]), toBufferBE(start, 32), countBuf]);
+
+    this.proc!.stdin!.write(buffer);
+
+    const numValues = (await this.stdout.read(4)).readUInt32BE(0);
+    const result = numValues ? await this.stdout.read(numValues * 32) : Buffer.alloc(0);
+
+    const values: Buffer[] = [];
+    for (let i = 0; i < numValues; ++i) {
+      values.push(result.slice(i * 32, i * 32 + 32));
+    }
+    return values;
+  }
+
+  /**
+   * Returns whether each nullifier is in the nullifier tree. Answered from memory, so cheap for large batches.
+   */
+  public nullifiersExist(nullifiers: bigint[]): Promise<boolean[]> {
+    return new Promise(resolve => this.stdioQueue.put(async () => resolve(await this.nullifiersExist_(nullifiers))));
+  }
+
+  private async nullifiersExist_(nullifiers: bigint[]) {
+    const countBuf = Buffer.alloc(4);
+    countBuf.writeUInt32BE(nullifiers.length, 0);
+    const buffer = Buffer.concat([
+      Buffer.from([Command.NULLIFIERS_EXIST]),
+      countBuf,
+      ...nullifiers.map(n => toBufferBE(n, 32)),
+    ]);
+
+    this.proc!.stdin!.write(buffer);
+
+    const numResults = (await this.stdout.read(4)).readUInt32BE(0);
+    const result = numResults ? await this.stdout.read(numResults) : Buffer.alloc(0);
+    return [...result].map(exists => exists === 1);
+  }
+
+  /**
+   * Returns the index of each value in the data tree (commitments) or root tree (data roots), or undefined if absent.
+   */
+  public findLeafIndices(treeId: number, values: Buffer[]): Promise<(bigint | undefined)[]> {
+    return new Promise(resolve =>
+      this.stdioQueue.put(async () => resolve(await this.findLeafIndices_(treeId, values))),
+    );
+  }
+
+  private async findLeafIndices_(treeId: number, values: Buffer[]) {
+    const countBuf = Buffer.alloc(4);
+    countBuf.writeUInt32BE(values.length, 0);
+    const buffer = Buffer.concat([Buffer.from([Command.FIND_LEAF_INDICES, treeId]), countBuf, ...values]);
+
+    this.proc!.stdin!.write(buffer);
+
+    const numResults = (await this.stdout.read(4)).readUInt32BE(0);
+    const result = numResults ? await this.stdout.read(numResults * 33) : Buffer.alloc(0);
+
+    const indices: (bigint | undefined)[] = [];
+    for (let i = 0; i < numResults; ++i) {
+      const found = result[i * 33] === 1;
+      indices.push(found ? toBigIntBE(result.slice(i * 33 + 1, i * 33 + 33)) : undefined);
+    }
+    return indices;
+  }
+
   public getHashPath(treeId: number, index: bigint): Promise<HashPath> {
     return new Promise(resolve => this.stdioQueue.put(async () => resolve(await this.getHashPath_(treeId, index))));
   }
@@ -91,6 +187,32 @@ export class WorldStateDb {
 
     this.proc!.stdin!.write(buffer);
 
+    return await this.readHashPath();
+  }
+
+  /**
+   * Returns the hash path of a leaf below the tree's root as of a past version, or undefined if that version has been
+   * pruned. A version is the index in the root tree of the latest data root, recorded by the commit that added it, so
+   * the data tree as of `dataRootsIndex` is the one a tx referencing that data root was proven against.
+   */
+  public getHashPathAt(treeId: number, version: number, index: bigint): Promise<HashPath | undefined> {
+    return new Promise(resolve =>
+      this.stdioQueue.put(async () => resolve(await this.getHashPathAt_(treeId, version, index))),
+    );
+  }
+
+  private async getHashPathAt_(treeId: number, version: number, index: bigint) {
+    const versionBuf = Buffer.alloc(4);
+    versionBuf.writeUInt32BE(version, 0);
+    const buffer = Buffer.concat([Buffer.from([Command.GET_PATH_AT, treeId]), versionBuf, toBufferBE(index, 32)]);
+
+    this.proc!.stdin!.write(buffer);
+
+    const found = (await this.stdout.read(1))[0] === 1;
+    return found ? await this.readHashPath() : undefined;
+  }
+
+  private async readHashPath() {
     const depth = (await this.stdout.read(4)).readUInt32BE(0);
     const result = await this.stdout.read(depth * 64);
 
@@ -148,6 +270,34 @@ export class WorldStateDb {
     });
   }
 
+  /**
+   * Returns the number of the last commit, and of the last commit written to disk. With `asyncCommit` these can
+   * differ, as `commit` returns once the commit is logged. If `wait` is set, waits until all commits are on disk.
+   */
+  public persisted(wait = false) {
+    return new Promise<{ committed: bigint; persisted: bigint }>(resolve =>
+      this.stdioQueue.put(async () => {
+        this.proc!.stdin!.write(Buffer.from([Command.PERSISTED, wait ? 1 : 0]));
+        const result = await this.stdout.read(16);
+        resolve({ committed: result.readBigUInt64BE(0), persisted: result.readBigUInt64BE(8) });
+      }),
+    );
+  }
+
+  /**
+   * Returns db_cli's metrics, in Prometheus' text format.
+   */
+  public stats() {
+    return new Promise<string>(resolve =>
+      this.stdioQueue.put(async () => {
+        this.proc!.stdin!.write(Buffer.from([Command.STATS]));
+        const length = (await this.stdout.read(4)).readUInt32BE(0);
+        const stats = length ? await this.stdout.read(length) : Buffer.alloc(0);
+        resolve(stats.toString());
+      }),
+    );
+  }
+
   public async rollback() {
     await new Promise<void>(resolve => {
       this.stdioQueue.put(async () => {
@@ -159,13 +309,70 @@ export class WorldStateDb {
     });
   }
 
+  /**
+   * Creates an in memory overlay on the database (or on the `parent` overlay), and selects it.
+   * Reads and writes go to the selected overlay until another is selected. Returns false if the overlay exists, or the
+   * parent does not.
+   */
+  public fork(name: string, parent = '') {
+    return this.overlayCommand(
+      Command.FORK,
+      serializeBufferToVector(Buffer.from(name)),
+      serializeBufferToVector(Buffer.from(parent)),
+    );
+  }
+
+  /**
+   * Selects an overlay, or the database if `name` is empty.
+   */
+  public select(name = '') {
+    return this.overlayCommand(Command.SELECT, serializeBufferToVector(Buffer.from(name)));
+  }
+
+  /**
+   * Applies an overlay's writes to its parent and selects the parent. Writes merged into the database still need to be
+   * committed. Returns false if the overlay does not exist, has child overlays, or its parent has changed since the fork
+   * (e.g. a sibling was merged into it first), in which case the overlay is kept and can be dropped.
+   */
+  public merge(name: string) {
+    return this.overlayCommand(Command.MERGE, serializeBufferToVector(Buffer.from(name)));
+  }
+
+  /**
+   * Discards an overlay and selects its parent. Returns false if the overlay does not exist or has child overlays.
+   */
+  public drop(name: string) {
+    return this.overlayCommand(Command.DROP, serializeBufferToVector(Buffer.from(name)));
+  }
+
+  private overlayCommand(command: Command, ...args: Buffer[]) {
+    return new Promise<boolean>(resolve =>
+      this.stdioQueue.put(async () => {
+        this.proc!.stdin!.write(Buffer.concat([Buffer.from([command]), ...args]));
+        const success = (await this.stdout.read(1))[0] === 1;
+        if (success) {
+          await this.readMetadata();
+        }
+        resolve(success);
+      }),
+    );
+  }
+
   public destroy() {
     execSync(`${this.binPath} reset ${this.dbPath}`);
   }
 
   private async launch() {
     await mkdirp('./data');
-    const proc = (this.proc = spawn(this.binPath, [this.dbPath]));
+    const { servedVersions = 0, nodeCacheSize = 2 ** 18, asyncCommit = false, metricsPath = '' } = this.options;
+    const args = [
+      this.dbPath,
+      servedVersions.toString(),
+      nodeCacheSize.toString(),
+      asyncCommit.toString(),
+      metricsPath,
+    ];
+    const proc = (this.proc = spawn(this.binPath, args));
 
     proc.stderr.on('data', () => {});
     proc.on('close', code => {
@@ -257,6 +257,7 @@ describe('world_state', () => {
         }
         return randomBytes(32);
       }),
+      nullifiersExist: jest.fn((indices: bigint[]) => indices.map(index => !!nullifiers[index.toString()])),
       stop: jest.fn(),
     } as Mockify<WorldStateDb>;
 
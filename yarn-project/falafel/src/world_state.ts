@@ -445,9 +445,17 @@ export class WorldState {
       accumulatedDeposit: bigint;
     }[] = [];
     const discardedCommitments: { [key: string]: number } = {};
-    const spentNoteNullifier = toBufferBE(1n, 32);
 
-    for (const tx of txs) {
+    // look up every nullifier in one request, rather than a tree read per nullifier
+    const txNullifiers = txs.map(tx => {
+      const proof = new ProofData(tx.proofData);
+      return [proof.nullifier1, proof.nullifier2].map(n => toBigIntBE(n)).filter(n => n != 0n);
+    });
+    const allNullifiers = txNullifiers.flat();
+    const nullifiersExist = await this.worldStateDb.nullifiersExist(allNullifiers);
+    const spentNullifiers = new Set(allNullifiers.filter((_, i) => nullifiersExist[i]));
+
+    for (const [txIndex, tx] of txs.entries()) {
       const proof = new ProofData(tx.proofData);
 
       const discardTx = () => {
@@ -466,17 +474,7 @@ export class WorldState {
 
       // now we test the txs nullifiers to see if they are already in the nullifier tree
       // if they are then it means the txs note/s have already been spent by another tx
-      const nullifierIndices = [proof.nullifier1, proof.nullifier2].map(n => toBigIntBE(n)).filter(n => n != 0n);
-      let spentNotes = false;
-      for (const nullifierIndex of nullifierIndices) {
-        const value = await this.worldStateDb.get(RollupTreeId.NULL, nullifierIndex);
-        if (value.equals(spentNoteNullifier)) {
-          spentNotes = true;
-          break;
-        }
-      }
-
-      if (spentNotes) {
+      if (txNullifiers[txIndex].some(n => spentNullifiers.has(n))) {
         discardTx();
         continue;
       }
@@ -0,0 +1,78 @@
+import { numToUInt32BE, serializeBufferToVector } from '@aztec/barretenberg/serialize';
+import { randomBytes } from 'crypto';
+import { PromiseReadable } from 'promise-readable';
+import { PassThrough } from 'stream';
+import { readBlockProof } from './block.js';
+import { ProofResponse, readProofResponse } from './proof_response.js';
+
+const response = (data: Buffer, verified: boolean) =>
+  Buffer.concat([serializeBufferToVector(data), Buffer.from([verified ? 1 : 0])]);
+
+describe('Block', () => {
+  let stdout: PassThrough;
+  let readable: PromiseReadable<any>;
+  const readResponse = () => readProofResponse(readable);
+
+  beforeEach(() => {
+    stdout = new PassThrough();
+    readable = new PromiseReadable(stdout);
+  });
+
+  it('reads every stage of a proven block', async () => {
+    const txRollups = [randomBytes(100), randomBytes(100)];
+    const rootRollup = randomBytes(200);
+    const rootVerifier = randomBytes(300);
+    stdout.write(
+      Buffer.concat([
+        ...txRollups.map(p => response(p, true)),
+        response(rootRollup, true),
+        response(rootVerifier, true),
+      ]),
+    );
+
+    const streamed: ProofResponse[] = [];
+    const block = await readBlockProof(txRollups.length, readResponse, r => streamed.push(r));
+
+    expect(block.verified).toBe(true);
+    expect(block.txRollups).toEqual(txRollups.map(data => ({ data, verified: true })));
+    expect(block.rootRollup).toEqual({ data: rootRollup, verified: true });
+    expect(block.rootVerifier).toEqual({ data: rootVerifier, verified: true });
+    expect(streamed).toEqual([...block.txRollups, block.rootRollup, block.rootVerifier]);
+  });
+
+  it('stops at a tx rollup that fails mid block', async () => {
+    const proven = randomBytes(100);
+    const next = randomBytes(32);
+    // rollup_cli writes nothing more for the block after a failure, so what follows is the next request's response.
+    stdout.write(Buffer.concat([response(proven, true), response(Buffer.alloc(0), false), response(next, true)]));
+
+    const block = await readBlockProof(3, readResponse);
+
+    expect(block.verified).toBe(false);
+    expect(block.txRollups).toEqual([
+      { data: proven, verified: true },
+      { data: Buffer.alloc(0), verified: false },
+    ]);
+    expect(block.rootRollup).toBeUndefined();
+    expect(block.rootVerifier).toBeUndefined();
+    expect(await readResponse()).toEqual({ data: next, verified: true });
+  });
+
+  it('stops at a root rollup that fails', async () => {
+    const txRollup = randomBytes(100);
+    const rootRollup = randomBytes(200);
+    stdout.write(Buffer.concat([response(txRollup, true), response(rootRollup, false)]));
+
+    const block = await readBlockProof(1, readResponse);
+
+    expect(block.verified).toBe(false);
+    expect(block.rootRollup).toEqual({ data: rootRollup, verified: false });
+    expect(block.rootVerifier).toBeUndefined();
+  });
+
+  it('fails on a stream that ends mid block', async () => {
+    stdout.end(Buffer.concat([response(randomBytes(100), true), numToUInt32BE(100)]));
+
+    await expect(readBlockProof(2, readResponse)).rejects.toThrow();
+  });
+});
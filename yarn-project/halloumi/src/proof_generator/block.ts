@@ -0,0 +1,78 @@
+import { numToUInt32BE, serializeBufferArrayToVector } from '@aztec/barretenberg/serialize';
+import { ProofId } from './proof_request.js';
+import { ProofResponse } from './proof_response.js';
+import { RootRollup } from './root_rollup.js';
+import { TxRollup } from './tx_rollup.js';
+
+/**
+ * Proves a whole block in one request: its tx rollups, the root rollup of them, and the root verifier of that. The
+ * root rollup's proofs are ignored, and filled in with the tx rollup proofs.
+ */
+export class BlockProofRequest {
+  proofId = ProofId.BLOCK;
+
+  constructor(public txRollups: TxRollup[], public rootRollup: RootRollup) {}
+
+  toBuffer() {
+    return Buffer.concat([
+      numToUInt32BE(this.proofId),
+      serializeBufferArrayToVector(this.txRollups.map(r => r.toBuffer())),
+      this.rootRollup.toBuffer(),
+    ]);
+  }
+}
+
+/**
+ * The number of tx rollups in a serialized block request, which is how many tx rollup responses to expect.
+ */
+export function getNumTxRollups(request: Buffer) {
+  return request.readUInt32BE(4);
+}
+
+/**
+ * The responses to a block request, up to the first that failed. Each is in the format of the response to the request
+ * for that stage alone.
+ */
+export class BlockProof {
+  constructor(
+    public txRollups: ProofResponse[] = [],
+    public rootRollup?: ProofResponse,
+    public rootVerifier?: ProofResponse,
+  ) {}
+
+  get verified() {
+    return !!this.rootVerifier?.verified;
+  }
+}
+
+/**
+ * Reads the responses rollup_cli streams back for a block request of `numTxRollups` tx rollups: one per tx rollup, then
+ * the root rollup's, then the root verifier's. rollup_cli stops after the first that fails, and so does this, so the
+ * stream is left at the next request's response. `onResponse` is called with each as it arrives.
+ */
+export async function readBlockProof(
+  numTxRollups: number,
+  readResponse: () => Promise<ProofResponse>,
+  onResponse: (response: ProofResponse) => void = () => {},
+) {
+  const block = new BlockProof();
+  const read = async () => {
+    const response = await readResponse();
+    onResponse(response);
+    return response;
+  };
+
+  while (block.txRollups.length < numTxRollups) {
+    const response = await read();
+    block.txRollups.push(response);
+    if (!response.verified) {
+      return block;
+    }
+  }
+  block.rootRollup = await read();
+  if (!block.rootRollup.verified) {
+    return block;
+  }
+  block.rootVerifier = await read();
+  return block;
+}
@@ -4,13 +4,26 @@ import { PromiseReadable } from 'promise-readable';
 import { createInterface } from 'readline';
 import { MemoryFifo } from '@aztec/barretenberg/fifo';
 import { ProofGenerator } from './proof_generator.js';
-import { numToUInt32BE } from '@aztec/barretenberg/serialize';
+import {
+  deserializeArrayFromVector,
+  deserializeBufferFromVector,
+  numToUInt32BE,
+  serializeBufferArrayToVector,
+  serializeBufferToVector,
+} from '@aztec/barretenberg/serialize';
+import { createHash } from 'crypto';
 import fs from 'fs-extra';
+import { ProofId } from './proof_request.js';
+import { ProofResponse, readProofResponse, readVector } from './proof_response.js';
+import { BlockProofRequest, getNumTxRollups, readBlockProof } from './block.js';
 const { unlink, writeFile, pathExists, mkdirp, rename } = fs;
 
 enum CommandCodes {
+  ROOT_ROLLUP_BY_REFERENCE = 5,
+  ROOT_VERIFIER_BY_REFERENCE = 6,
   GET_JOIN_SPLIT_VK = 100,
   GET_ACCOUNT_VK = 101,
+  GET_STATS = 102,
   PING = 666,
 }
 
@@ -44,26 +57,8 @@ export class CliProofGenerator implements ProofGenerator {
     await this.start();
   }
 
-  private async readVector() {
-    const length = (await this.stdout.read(4)) as Buffer | undefined;
-
-    if (!length) {
-      throw new Error('Failed to read length.');
-    }
-
-    const vectorLen = length.readUInt32BE(0);
-
-    if (vectorLen === 0) {
-      return Buffer.alloc(0);
-    }
-
-    const data = (await this.stdout.read(vectorLen)) as Buffer | undefined;
-
-    if (!data) {
-      throw new Error('Failed to read data.');
-    }
-
-    return data;
+  private readVector() {
+    return readVector(this.stdout);
   }
 
   public getJoinSplitVk() {
@@ -80,6 +75,16 @@ export class CliProofGenerator implements ProofGenerator {
     });
   }
 
+  /**
+   * Returns rollup_cli's metrics, in Prometheus' text format.
+   */
+  public getStats() {
+    return this.serialExecute(async () => {
+      this.proc!.stdin!.write(numToUInt32BE(CommandCodes.GET_STATS));
+      return (await this.readVector()).toString();
+    });
+  }
+
   public async start() {
     await this.ensureCrs();
     this.launch();
@@ -116,20 +121,67 @@ export class CliProofGenerator implements ProofGenerator {
    */
   public async interrupt() {}
 
-  private async createProofInternal(buffer: Buffer) {
+  private sendProofRequest(buffer: Buffer) {
     this.proc!.stdin!.write(buffer);
-    const data = await this.readVector();
-    const verified = (await this.stdout.read(1)) as Buffer | undefined;
+    return readProofResponse(this.stdout);
+  }
 
-    if (!verified) {
-      throw new Error('Failed to read verified.');
+  private sendBlockRequest(buffer: Buffer, onResponse?: (response: ProofResponse) => void) {
+    this.proc!.stdin!.write(buffer);
+    return readBlockProof(getNumTxRollups(buffer), () => readProofResponse(this.stdout), onResponse);
+  }
+
+  private async createProofInternal(buffer: Buffer) {
+    // A block is answered with a response per stage. Its proof is the root verifier's.
+    if (buffer.readUInt32BE(0) === ProofId.BLOCK) {
+      const block = await this.sendBlockRequest(buffer);
+      if (!block.verified) {
+        throw new Error('Proof invalid.');
+      }
+      return block.rootVerifier!.data;
     }
 
-    if (!verified[0]) {
+    const byReference = this.toByReference(buffer);
+    let result = byReference ? await this.sendProofRequest(byReference) : undefined;
+
+    // A miss in rollup_cli's artifact cache is answered with no proof. Resend with the proofs inline.
+    if (!result || (!result.verified && !result.data.length)) {
+      result = await this.sendProofRequest(buffer);
+    }
+
+    if (!result.verified) {
       throw new Error('Proof invalid.');
     }
 
-    return data;
+    return result.data;
+  }
+
+  /**
+   * rollup_cli keeps the tx rollup proofs and root rollup responses it returns, so root rollup and root verifier
+   * requests can send the sha256 of those instead of the bytes. Returns undefined for other requests.
+   */
+  private toByReference(buffer: Buffer) {
+    const hash = (data: Buffer) => createHash('sha256').update(data).digest();
+    const proofId = buffer.readUInt32BE(0);
+
+    if (proofId === ProofId.ROOT_ROLLUP) {
+      // The root rollup is the rollup id, the number of inner rollups, the vector of their proofs, then the rest.
+      const proofs = deserializeArrayFromVector(deserializeBufferFromVector, buffer, 12);
+      return Buffer.concat([
+        numToUInt32BE(CommandCodes.ROOT_ROLLUP_BY_REFERENCE),
+        buffer.slice(4, 12),
+        serializeBufferArrayToVector(proofs.elem.map(p => serializeBufferToVector(hash(p)))),
+        buffer.slice(12 + proofs.adv),
+      ]);
+    }
+
+    if (proofId === ProofId.ROOT_VERIFIER) {
+      const rootRollupProofBuf = deserializeBufferFromVector(buffer, 4);
+      return Buffer.concat([
+        numToUInt32BE(CommandCodes.ROOT_VERIFIER_BY_REFERENCE),
+        serializeBufferToVector(hash(rootRollupProofBuf.elem)),
+      ]);
+    }
   }
 
   private serialExecute<T>(fn: () => Promise<T>): Promise<T> {
@@ -149,6 +201,14 @@ export class CliProofGenerator implements ProofGenerator {
     return this.serialExecute(() => this.createProofInternal(data));
   }
 
+  /**
+   * Proves a whole block in one round trip. rollup_cli streams back each stage's response as it's done, which is
+   * passed to `onResponse` as it arrives, so a failed block can be told apart by the stage it failed at.
+   */
+  public createBlockProof(request: BlockProofRequest, onResponse?: (response: ProofResponse) => void) {
+    return this.serialExecute(() => this.sendBlockRequest(request.toBuffer(), onResponse));
+  }
+
   private async ensureCrs() {
     const pointPerTranscript = 5040000;
 
@@ -8,3 +8,5 @@ export * from './tx_rollup.js';
 export * from './root_rollup.js';
 export * from './claim_proof.js';
 export * from './root_verifier.js';
+export * from './block.js';
+export * from './proof_response.js';
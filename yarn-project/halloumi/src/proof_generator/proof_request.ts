@@ -9,6 +9,7 @@ export enum ProofId {
   ROOT_ROLLUP,
   CLAIM,
   ROOT_VERIFIER,
+  BLOCK = 7,
 }
 
 export class TxRollupProofRequest {
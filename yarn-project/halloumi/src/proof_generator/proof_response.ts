@@ -0,0 +1,45 @@
+import { PromiseReadable } from 'promise-readable';
+
+/**
+ * A proof, or the response for a stage of a block, and whether it verified.
+ */
+export interface ProofResponse {
+  data: Buffer;
+  verified: boolean;
+}
+
+export async function readVector(stdout: PromiseReadable<any>) {
+  const length = (await stdout.read(4)) as Buffer | undefined;
+
+  if (!length) {
+    throw new Error('Failed to read length.');
+  }
+
+  const vectorLen = length.readUInt32BE(0);
+
+  if (vectorLen === 0) {
+    return Buffer.alloc(0);
+  }
+
+  const data = (await stdout.read(vectorLen)) as Buffer | undefined;
+
+  if (!data) {
+    throw new Error('Failed to read data.');
+  }
+
+  return data;
+}
+
+/**
+ * Reads rollup_cli's response to a proof request: the proof, then a byte that's non zero if it verified.
+ */
+export async function readProofResponse(stdout: PromiseReadable<any>): Promise<ProofResponse> {
+  const data = await readVector(stdout);
+  const verified = (await stdout.read(1)) as Buffer | undefined;
+
+  if (!verified) {
+    throw new Error('Failed to read verified.');
+  }
+
+  return { data, verified: !!verified[0] };
+}